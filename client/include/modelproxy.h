@@ -72,12 +72,23 @@ public:
 
     static unsigned getModelIndex(const std::string& algName);
 
+    /// Returns the results of the models in a reply of a server.
+    /**
+     * An ensemble reply carries the results of its models in Components,
+     * the results of models the client does not combine (ARIMA) are left
+     * out. Returns false for a reply of an unknown model and for an ensemble
+     * reply without the results of its models.
+     */
+    static bool getResults(const comm::protocol::Message& reply,
+            std::vector<ResultInfo>& results);
+
 private:
     void sendInitPacket();
     void initConnection();
 
 private:
     static const char* MODELS[];
+    static const char* ENSEMBLE;
 
     bool _running;
     comm::connection _connection;
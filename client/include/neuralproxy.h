@@ -27,8 +27,10 @@
 
 #include <neural/neuralnet.h>
 #include <dataprovider/dataprovider.h>
+#include <dataprovider/erroraccumulator.h>
 #include <parsedopts.h>
 #include <outputwriter.h>
+#include <modelproxy.h>
 
 #include <boost/thread.hpp>
 
@@ -45,6 +47,8 @@ public:
     virtual ~NeuralProxy();
 
     void insertInput(double input, int modelIdx);
+    /// Inserts the results of all the models in a reply at once.
+    void insertInputs(const std::vector<ResultInfo>& results);
 
     void operator()();
 
@@ -60,6 +64,7 @@ private:
     void createResultLog();
     void compareResults(double& prediction, double expected,
             const std::vector<double>& inputs);
+    void writeErrors(std::ostream& out) const;
 
 private:
     std::string _inputFilePath;
@@ -72,16 +77,20 @@ private:
     boost::thread _thread;
     models::neural::NeuralNet* _neuralNet;
     const ParsedOptions& _opts;
-    boost::shared_ptr<models::dataprovider::DataProvider> _dataProvider;
+    /// The series at the resolution of the predictions.
+    boost::shared_ptr<const models::dataprovider::DataProvider> _dataProvider;
     boost::shared_ptr<OutputWriter> _outputWriter;
     bool _writeOutput;
+    /// Errors of the outputs of the model servers and of the net.
+    std::vector<models::dataprovider::ErrorAccumulator> _modelErrors;
+    models::dataprovider::ErrorAccumulator _mainErrors;
 
 };
 
 inline
 unsigned NeuralProxy::getTestDataSize()
 {
-    if( _dataProvider != boost::shared_ptr<models::dataprovider::DataProvider>())
+    if( _dataProvider != boost::shared_ptr<const models::dataprovider::DataProvider>())
     {
         return _dataProvider->getDataSize();
     }
@@ -58,6 +58,14 @@ struct ParsedOptions
     unsigned PredictionStep;
     unsigned NumberSteps;
     unsigned Horizon;
+    unsigned Priority;
+    unsigned Deadline;
+    std::string DatasetId;
+    bool Latest;
+    unsigned Resolution;
+    unsigned Aggregation;
+    std::string SeriesId;
+    unsigned ReportInterval;
 };
 
 //namespace std
@@ -80,6 +88,14 @@ inline std::ostream &operator<<(std::ostream &out, const prediction::client::Par
     out << "PredictionStep: " << opts.PredictionStep << std::endl;
     out << "NumberSteps: " << opts.NumberSteps << std::endl;
     out << "Horizon: " << opts.Horizon << std::endl;
+    out << "Priority: " << opts.Priority << std::endl;
+    out << "Deadline: " << opts.Deadline << std::endl;
+    out << "DatasetId: " << opts.DatasetId << std::endl;
+    out << "Latest: " << opts.Latest << std::endl;
+    out << "Resolution: " << opts.Resolution << std::endl;
+    out << "Aggregation: " << opts.Aggregation << std::endl;
+    out << "SeriesId: " << opts.SeriesId << std::endl;
+    out << "ReportInterval: " << opts.ReportInterval << std::endl;
     out << std::endl;
     return out;
 }
@@ -26,6 +26,7 @@
 #include <predictionclient.h>
 
 #include <parsedopts.h>
+#include <dataprovider/aggregationpyramid.h>
 #include <util.h>
 
 #include <iostream>
@@ -96,6 +97,34 @@ ParsedOptions parseOptions(int argc, char *argv[])
     ("horizon,H", po::value<unsigned>()->default_value(1),
             "set the forecast horizon")
 
+    ("priority,p", po::value<std::string>()->default_value("normal"),
+            "set scheduling class of the requests: realtime, normal, bulk")
+
+    ("deadline", po::value<unsigned>()->default_value(0),
+            "set time budget of a single request in milliseconds (0 - none)")
+
+    ("dataset", po::value<std::string>(),
+            "set name of the dataset on the server (default - the one the "
+            "server was started with)")
+
+    ("latest",
+            "predict from the newest values of a server following its input "
+            "file instead of the given offsets")
+
+    ("series", po::value<std::string>(),
+            "set id of a series of the server's series store to predict")
+
+    ("resolution", po::value<unsigned>()->default_value(1),
+            "set number of samples aggregated into one value of the predicted "
+            "series, the server has to be started with this resolution")
+
+    ("aggregation", po::value<std::string>()->default_value("mean"),
+            "set how the samples are aggregated: mean, sum, max")
+
+    ("report-interval", po::value<unsigned>()->default_value(0),
+            "log the error metrics of the neural mode every given number of "
+            "steps (0 - only at the end)")
+
     ("debug-level,d",
             po::value<unsigned>()->default_value(debug::Informational),
             "set debug level (0-4)");
@@ -194,6 +223,67 @@ ParsedOptions parseOptions(int argc, char *argv[])
         opts.NumberSteps = vm["num-steps"].as<unsigned>();
     }
 
+    opts.Priority = comm::protocol::Normal;
+    if (vm.count("priority"))
+    {
+        std::string priority = vm["priority"].as<std::string> ();
+        if (priority == "realtime")
+        {
+            opts.Priority = comm::protocol::Realtime;
+        }
+        else if (priority == "bulk")
+        {
+            opts.Priority = comm::protocol::Bulk;
+        }
+        else if (priority != "normal")
+        {
+            dbg(debug::High) << "Incorrect priority provided. Exiting."
+                    << std::endl;
+            exit(1);
+        }
+    }
+
+    if (vm.count("deadline"))
+    {
+        opts.Deadline = vm["deadline"].as<unsigned> ();
+    }
+
+    if (vm.count("dataset"))
+    {
+        opts.DatasetId = vm["dataset"].as<std::string> ();
+    }
+
+    opts.Latest = vm.count("latest") > 0;
+
+    if (vm.count("series"))
+    {
+        opts.SeriesId = vm["series"].as<std::string> ();
+    }
+
+    if (vm.count("resolution"))
+    {
+        opts.Resolution = vm["resolution"].as<unsigned> ();
+    }
+
+    opts.Aggregation = models::dataprovider::AggregationPyramid::Mean;
+    if (vm.count("aggregation"))
+    {
+        models::dataprovider::AggregationPyramid::Aggregation aggregation;
+        if (!models::dataprovider::AggregationPyramid::parseAggregation(
+                vm["aggregation"].as<std::string> (), aggregation))
+        {
+            dbg(debug::High) << "Incorrect aggregation provided. Exiting."
+                    << std::endl;
+            exit(1);
+        }
+        opts.Aggregation = aggregation;
+    }
+
+    if (vm.count("report-interval"))
+    {
+        opts.ReportInterval = vm["report-interval"].as<unsigned> ();
+    }
+
     if (vm.count("mode"))
     {
         opts.Mode = vm["mode"].as<std::string> ();
@@ -44,6 +44,8 @@ const unsigned SLEEP_TIME = 10;
 const char* ModelProxy::MODELS[] =
 { "chaos", "grey", "neural" };
 
+const char* ModelProxy::ENSEMBLE = "ensemble";
+
 ModelProxy::ModelProxy(boost::asio::io_service& io_service,
         boost::asio::ip::tcp::resolver::iterator endpoint_iterator,
         const ParsedOptions& opts, ServerData sd,
@@ -160,6 +162,12 @@ void ModelProxy::handle_read(const boost::system::error_code& e)
                 << _connection.socket().remote_endpoint().port() << std::endl;
         dbg() << _inBuffer << std::endl;
 
+        if (!_inBuffer.Error.empty())
+        {
+            dbg(debug::High) << "Server error: " << _inBuffer.Error
+                    << std::endl;
+        }
+
         _modelIndex = getModelIndex(_inBuffer.Algorithm);
 
         addResult(_inBuffer.Result);
@@ -202,6 +210,55 @@ unsigned ModelProxy::getModelIndex(const std::string& algName)
     return -1;
 }
 
+bool ModelProxy::getResults(const comm::protocol::Message& reply,
+        std::vector<ResultInfo>& results)
+{
+    results.clear();
+
+    if (reply.Algorithm != ENSEMBLE)
+    {
+        unsigned modelIdx = getModelIndex(reply.Algorithm);
+        if (modelIdx == unsigned(-1))
+        {
+            dbg(debug::High) << "Reply of an unknown model "
+                    << reply.Algorithm << std::endl;
+            return false;
+        }
+        results.push_back(ResultInfo(reply.Result, modelIdx));
+        return true;
+    }
+
+    if (reply.Components.empty()
+            || reply.Components.size() != reply.ComponentAlgorithms.size())
+    {
+        dbg(debug::High) << "Ensemble reply without the results of its "
+                "models (" << reply.Components.size() << " results of "
+                << reply.ComponentAlgorithms.size() << " models)"
+                << std::endl;
+        return false;
+    }
+
+    for (size_t i = 0; i < reply.Components.size(); ++i)
+    {
+        unsigned modelIdx = getModelIndex(reply.ComponentAlgorithms[i]);
+        if (modelIdx == unsigned(-1))
+        {
+            dbg() << "Skipping the result of "
+                    << reply.ComponentAlgorithms[i] << std::endl;
+            continue;
+        }
+        results.push_back(ResultInfo(reply.Components[i], modelIdx));
+    }
+
+    if (results.empty())
+    {
+        dbg(debug::High) << "Ensemble reply without the results of the "
+                "models combined by the client" << std::endl;
+        return false;
+    }
+    return true;
+}
+
 void ModelProxy::sendInitPacket()
 {
     dbg() << "Sending init packet: " << std::endl;
@@ -213,6 +270,13 @@ void ModelProxy::sendInitPacket()
     _outBuffer.DataOffset = _opts.DataOffset;
     _outBuffer.DataLength = _opts.DataLength;
     _outBuffer.Horizon = _opts.Horizon;
+    _outBuffer.Priority = _opts.Priority;
+    _outBuffer.Deadline = _opts.Deadline;
+    _outBuffer.DatasetId = _opts.DatasetId;
+    _outBuffer.Latest = _opts.Latest;
+    _outBuffer.Resolution = _opts.Resolution;
+    _outBuffer.Aggregation = _opts.Aggregation;
+    _outBuffer.SeriesId = _opts.SeriesId;
 
     dbg() << _outBuffer << std::endl;
 
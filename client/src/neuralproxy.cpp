@@ -25,6 +25,7 @@
 
 #include <neuralproxy.h>
 
+#include <dataprovider/aggregationpyramid.h>
 #include <util.h>
 
 namespace prediction
@@ -38,12 +39,15 @@ using namespace models::dataprovider;
 using namespace models::neural;
 
 NeuralProxy::NeuralProxy(const ParsedOptions& opts) :
-    _running(true), _thread(boost::ref(*this)), _opts(opts),
-            _writeOutput(false)
+    _running(true), _opts(opts), _writeOutput(false)
 {
     initBuffer();
     loadNet();
     createResultLog();
+
+    // started once the series is loaded, the thread compares with it
+    boost::thread thread(boost::ref(*this));
+    _thread.swap(thread);
 }
 
 void NeuralProxy::createResultLog()
@@ -59,8 +63,20 @@ void NeuralProxy::createResultLog()
 void NeuralProxy::loadNet()
 {
     _neuralNet = NeuralNet::load(_opts.InputNet);
-    _dataProvider = boost::shared_ptr<DataProvider>(new DataProvider(
+    boost::shared_ptr<const DataProvider> data(new DataProvider(
             _opts.DataFile));
+    if (_opts.Resolution > 1)
+    {
+        // the offsets and the horizon count the aggregated values, the
+        // results are compared to the same series the server predicts
+        AggregationPyramid pyramid(*data,
+                std::vector<unsigned>(1, _opts.Resolution));
+        data = pyramid.getLevel(_opts.Resolution, _opts.Aggregation);
+        dbg(debug::Informational) << "Comparing with "
+                << data->getDataSize() << " values aggregated by "
+                << _opts.Resolution << std::endl;
+    }
+    _dataProvider = data;
     _neuralNet->setScale(1.0 / _dataProvider->getMaxValue());
 
     if (_opts.Mode == "training")
@@ -85,12 +101,28 @@ NeuralProxy::~NeuralProxy()
 }
 
 void NeuralProxy::insertInput(double input, int modelIdx)
+{
+    insertInputs(std::vector<ResultInfo>(1, ResultInfo(input, modelIdx)));
+}
+
+void NeuralProxy::insertInputs(const std::vector<ResultInfo>& results)
 {
     //  dbg(debug::Informational) << "Inserting input " << input << " from model " << modelIdx
     //          << std::endl;
     boost::lock_guard<boost::mutex> lock(_inputBufferMutex);
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        unsigned modelIdx = results[i].ModelId;
+        if (modelIdx >= _buffer.size())
+        {
+            // an ensemble server sends the results of several models
+            dbg(debug::Informational) << "Combining the results of "
+                    << modelIdx + 1 << " models" << std::endl;
+            _buffer.resize(modelIdx + 1);
+        }
+        _buffer[modelIdx].push_back(results[i].Result);
+    }
     dbg() << "Inserted input" << std::endl;
-    _buffer[modelIdx].push_back(input);
 
     if (hasInput())
     {
@@ -118,9 +150,9 @@ std::vector<double> NeuralProxy::getInput()
 {
     boost::unique_lock<boost::mutex> lock(_inputBufferMutex);
     std::vector<double> input;
-    input.resize(_opts.ModelServers.size());
+    input.resize(_buffer.size());
 
-    for (unsigned i = 0; i < _opts.ModelServers.size(); ++i)
+    for (unsigned i = 0; i < _buffer.size(); ++i)
     {
         double val = 0.0;
         if (_buffer[i].size() > 0)
@@ -142,10 +174,6 @@ void NeuralProxy::operator()()
     struct timeval start;
     gettimeofday(&start, 0);
 
-    std::vector<std::vector<double> > inputsGlob;
-    std::vector<double> expectedGlob;
-    std::vector<double> predictionGlob;
-
     while (_running)
     {
         unsigned offset = _opts.DataOffset + _opts.PredictionStep * counter
@@ -154,7 +182,7 @@ void NeuralProxy::operator()()
         bool finish = false;
 
         if (_dataProvider != boost::shared_ptr<
-                models::dataprovider::DataProvider>())
+                const models::dataprovider::DataProvider>())
         {
             finish = (offset + _opts.Horizon >= _dataProvider->getDataSize()) || (--numSteps <= 0);
         }
@@ -178,19 +206,18 @@ void NeuralProxy::operator()()
         {
             // insert input to neural network
             std::vector<double> inputVec(getInput());
-            if (inputsGlob.size() != inputVec.size())
+            double expected = _dataProvider->getData(offset + _opts.Horizon);
+
+            if (_modelErrors.size() != inputVec.size())
             {
-                inputsGlob.resize(inputVec.size());
+                _modelErrors.resize(inputVec.size());
             }
 
             for (unsigned i = 0; i < inputVec.size(); ++i)
             {
-                inputsGlob[i].push_back(inputVec[i]);
+                _modelErrors[i].add(expected, inputVec[i]);
             }
 
-            double expected = _dataProvider->getData(offset + _opts.Horizon);
-            expectedGlob.push_back(expected);
-
             if (finish)
             {
                 _running = false;
@@ -218,7 +245,7 @@ void NeuralProxy::operator()()
 
                     compareResults(prediction, expected, inputVec);
 
-                    predictionGlob.push_back(prediction);
+                    _mainErrors.add(expected, prediction);
 
                     dbg(debug::Informational) << "Got prediction: "
                             << prediction << std::endl;
@@ -226,6 +253,17 @@ void NeuralProxy::operator()()
                 }
             }
         }
+
+        if (_opts.ReportInterval > 0 && !_modelErrors.empty()
+                && _modelErrors.front().getCount() % _opts.ReportInterval
+                        == 0)
+        {
+            std::ostringstream report;
+            writeErrors(report);
+            dbg(debug::Informational) << "Errors after "
+                    << _modelErrors.front().getCount() << " steps:"
+                    << std::endl << report.str();
+        }
     }
 
     struct timeval end;
@@ -241,27 +279,28 @@ void NeuralProxy::operator()()
     std::ofstream timeFile(oss.str().c_str());
     timeFile << time << std::endl << std::endl;
 
-    for (unsigned i = 0; i < inputsGlob.size(); ++i)
+    writeErrors(timeFile);
+
+    _outputWriter->close();
+}
+
+void NeuralProxy::writeErrors(std::ostream& out) const
+{
+    for (unsigned i = 0; i < _modelErrors.size(); ++i)
     {
-        timeFile << "MSE (model " << i << "): "
-                << DataProvider::getMeanSquareError(expectedGlob, inputsGlob[i])
+        ErrorMetrics metrics(_modelErrors[i].getMetrics());
+        out << "MSE (model " << i << "): " << metrics.MeanSquareError
                 << std::endl;
-        timeFile << "NMSE (model " << i << "): "
-                << DataProvider::getNormalizedMeanSquareError(expectedGlob,
-                        inputsGlob[i]) << std::endl;
-        timeFile << "SER (model " << i << "): "
-                << DataProvider::getSignalToErrorRatio(expectedGlob,
-                        inputsGlob[i]) << std::endl << std::endl;
+        out << "NMSE (model " << i << "): "
+                << metrics.NormalizedMeanSquareError << std::endl;
+        out << "SER (model " << i << "): " << metrics.SignalToErrorRatio
+                << std::endl << std::endl;
     }
 
-    timeFile << "MSE (main): " << DataProvider::getMeanSquareError(expectedGlob,
-            predictionGlob) << std::endl;
-    timeFile << "NMSE (main): " << DataProvider::getNormalizedMeanSquareError(
-            expectedGlob, predictionGlob) << std::endl;
-    timeFile << "SER (main): " << DataProvider::getSignalToErrorRatio(
-            expectedGlob, predictionGlob) << std::endl;
-
-    _outputWriter->close();
+    ErrorMetrics metrics(_mainErrors.getMetrics());
+    out << "MSE (main): " << metrics.MeanSquareError << std::endl;
+    out << "NMSE (main): " << metrics.NormalizedMeanSquareError << std::endl;
+    out << "SER (main): " << metrics.SignalToErrorRatio << std::endl;
 }
 
 void NeuralProxy::join()
@@ -81,6 +81,13 @@ dbg() << "Sending init packet: " << std::endl;
 _outBuffers[buffnum].DataOffset = _opts.DataOffset;
 _outBuffers[buffnum].DataLength = _opts.DataLength;
 _outBuffers[buffnum].Horizon = _opts.Horizon;
+_outBuffers[buffnum].Priority = _opts.Priority;
+_outBuffers[buffnum].Deadline = _opts.Deadline;
+_outBuffers[buffnum].DatasetId = _opts.DatasetId;
+_outBuffers[buffnum].Latest = _opts.Latest;
+_outBuffers[buffnum].Resolution = _opts.Resolution;
+_outBuffers[buffnum].Aggregation = _opts.Aggregation;
+_outBuffers[buffnum].SeriesId = _opts.SeriesId;
 
 conn->async_write(_outBuffers[buffnum], boost::bind(&PredictionClient::handle_write,
                 this, boost::asio::placeholders::error, conn, buffnum));
@@ -135,8 +142,17 @@ if (!e)
     << conn->socket().remote_endpoint().port() << std::endl;
     dbg(debug::Informational) << _inBuffers[buffnum] << std::endl;
 
-    _neuralProxy->insertInput(_inBuffers[buffnum].Result,
-            ModelProxy::getModelIndex(_inBuffers[buffnum].Algorithm));
+    if (!_inBuffers[buffnum].Error.empty())
+    {
+        dbg(debug::High) << "Server error: " << _inBuffers[buffnum].Error
+                << std::endl;
+    }
+
+    std::vector<ResultInfo> results;
+    if (ModelProxy::getResults(_inBuffers[buffnum], results))
+    {
+        _neuralProxy->insertInputs(results);
+    }
 
     if( _outBuffers[buffnum].DataOffset + _opts.PredictionStep + _opts.Horizon + _opts.DataLength < dataSize)
     {
@@ -0,0 +1,123 @@
+//
+// Copyright (c) 2010 Dariusz Gadomski <dgadomski@gmail.com>
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#define BOOST_TEST_MODULE EnsembleReply
+#include <boost/test/included/unit_test.hpp>
+
+#include <modelproxy.h>
+
+#include <sstream>
+
+#include <boost/archive/text_iarchive.hpp>
+#include <boost/archive/text_oarchive.hpp>
+#include <boost/serialization/string.hpp>
+#include <boost/serialization/vector.hpp>
+
+using namespace prediction::client;
+namespace protocol = comm::protocol;
+
+namespace
+{
+
+/// Sends a reply through the archive the connections use.
+protocol::Message roundTrip(const protocol::Message& reply)
+{
+    std::ostringstream out;
+    {
+        boost::archive::text_oarchive archive(out);
+        archive << reply;
+    }
+    std::istringstream in(out.str());
+    boost::archive::text_iarchive archive(in);
+    protocol::Message received;
+    archive >> received;
+    return received;
+}
+
+protocol::Message ensembleReply()
+{
+    protocol::Message reply;
+    reply.Algorithm = "ensemble";
+    reply.Result = 10.0;
+    reply.ComponentAlgorithms.push_back("arima");
+    reply.ComponentAlgorithms.push_back("chaos");
+    reply.ComponentAlgorithms.push_back("grey");
+    reply.ComponentAlgorithms.push_back("neural");
+    reply.Components.push_back(1.0);
+    reply.Components.push_back(2.0);
+    reply.Components.push_back(3.0);
+    reply.Components.push_back(4.0);
+    return reply;
+}
+
+}
+
+BOOST_AUTO_TEST_CASE(feedsComponentsOfEnsemble)
+{
+    std::vector<ResultInfo> results;
+    BOOST_REQUIRE(ModelProxy::getResults(roundTrip(ensembleReply()), results));
+
+    // ARIMA is not combined by the client
+    BOOST_REQUIRE_EQUAL(results.size(), 3u);
+    for (unsigned i = 0; i < results.size(); ++i)
+    {
+        BOOST_CHECK_EQUAL(results[i].ModelId, i);
+        BOOST_CHECK_EQUAL(results[i].Result, 2.0 + i);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(rejectsEnsembleWithoutComponents)
+{
+    std::vector<ResultInfo> results;
+
+    protocol::Message reply(ensembleReply());
+    reply.Components.pop_back();
+    BOOST_CHECK(!ModelProxy::getResults(roundTrip(reply), results));
+    BOOST_CHECK(results.empty());
+
+    reply.Components.clear();
+    reply.ComponentAlgorithms.clear();
+    BOOST_CHECK(!ModelProxy::getResults(roundTrip(reply), results));
+
+    reply = ensembleReply();
+    reply.ComponentAlgorithms.assign(4, "arima");
+    BOOST_CHECK(!ModelProxy::getResults(roundTrip(reply), results));
+}
+
+BOOST_AUTO_TEST_CASE(feedsSingleModel)
+{
+    protocol::Message reply;
+    reply.Algorithm = "grey";
+    reply.Result = 5.0;
+
+    std::vector<ResultInfo> results;
+    BOOST_REQUIRE(ModelProxy::getResults(roundTrip(reply), results));
+    BOOST_REQUIRE_EQUAL(results.size(), 1u);
+    BOOST_CHECK_EQUAL(results[0].ModelId, 1u);
+    BOOST_CHECK_EQUAL(results[0].Result, 5.0);
+
+    reply.Algorithm = "arima";
+    BOOST_CHECK(!ModelProxy::getResults(roundTrip(reply), results));
+}
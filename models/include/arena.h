@@ -0,0 +1,178 @@
+/* * Copyright (c) 2010 Dariusz Gadomski <dgadomski@gmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation and/or
+ * other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef ARENA_H_
+#define ARENA_H_
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+
+namespace models
+{
+
+/// Monotonic allocator for the working memory of a single computation.
+/**
+ * Memory is handed out from large blocks by moving a pointer and is never
+ * freed one by one. reset() makes all of it available again while keeping
+ * the blocks, so after a few requests the computations allocate nothing
+ * from the heap. Whatever was allocated before reset() must not be used
+ * after it.
+ */
+class Arena: private boost::noncopyable
+{
+public:
+    static const size_t DEFAULT_BLOCK_SIZE = 64 * 1024;
+
+    explicit Arena(size_t blockSize = DEFAULT_BLOCK_SIZE);
+    ~Arena();
+
+    void* allocate(size_t size);
+    void reset();
+
+    /// Returns the number of bytes allocated since the last reset().
+    size_t getUsed() const;
+    size_t getCapacity() const;
+
+private:
+    struct Block
+    {
+        char *Data;
+        size_t Size;
+    };
+
+    std::vector<Block> _blocks;
+    size_t _blockSize;
+    // block being filled and the first free byte in it
+    size_t _current;
+    size_t _offset;
+    size_t _used;
+};
+
+inline size_t Arena::getUsed() const
+{
+    return _used;
+}
+
+/// Standard allocator drawing from an Arena. Without an arena it falls back
+/// to the heap.
+template<typename T>
+class ArenaAllocator
+{
+public:
+    typedef T value_type;
+    typedef T* pointer;
+    typedef const T* const_pointer;
+    typedef T& reference;
+    typedef const T& const_reference;
+    typedef size_t size_type;
+    typedef ptrdiff_t difference_type;
+
+    template<typename U>
+    struct rebind
+    {
+        typedef ArenaAllocator<U> other;
+    };
+
+    explicit ArenaAllocator(Arena *arena = 0) :
+        _arena(arena)
+    {
+    }
+
+    template<typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) :
+        _arena(other.getArena())
+    {
+    }
+
+    pointer allocate(size_type n, const void* = 0)
+    {
+        if (_arena)
+        {
+            return static_cast<pointer> (_arena->allocate(n * sizeof(T)));
+        }
+        return static_cast<pointer> (::operator new(n * sizeof(T)));
+    }
+
+    void deallocate(pointer p, size_type)
+    {
+        if (!_arena)
+        {
+            ::operator delete(p);
+        }
+    }
+
+    void construct(pointer p, const T& value)
+    {
+        new (p) T(value);
+    }
+
+    void destroy(pointer p)
+    {
+        p->~T();
+    }
+
+    pointer address(reference value) const
+    {
+        return &value;
+    }
+
+    const_pointer address(const_reference value) const
+    {
+        return &value;
+    }
+
+    size_type max_size() const
+    {
+        return size_t(-1) / sizeof(T);
+    }
+
+    Arena* getArena() const
+    {
+        return _arena;
+    }
+
+private:
+    Arena *_arena;
+};
+
+template<typename T, typename U>
+inline bool operator==(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b)
+{
+    return a.getArena() == b.getArena();
+}
+
+template<typename T, typename U>
+inline bool operator!=(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b)
+{
+    return a.getArena() != b.getArena();
+}
+
+typedef std::vector<double, ArenaAllocator<double> > ArenaVector;
+
+}
+
+#endif /* ARENA_H_ */
@@ -42,7 +42,7 @@ public:
     Arima();
     virtual ~Arima();
 
-    void provideInput(const std::vector<double>& input, unsigned horizon);
+    void provideInput(const DataView& input, unsigned horizon);
 
     double getPrediction(unsigned horizon);
 
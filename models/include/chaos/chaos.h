@@ -41,7 +41,7 @@ public:
     Chaos(unsigned d, unsigned t);
     virtual ~Chaos();
 
-    void provideInput(const std::vector<double>& inputValues, unsigned horizon);
+    void provideInput(const DataView& inputValues, unsigned horizon);
 
     double getPrediction(unsigned horizon);
 
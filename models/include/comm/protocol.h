@@ -28,7 +28,10 @@
 #include <util.h>
 
 #include <boost/serialization/string.hpp>
+#include <boost/serialization/vector.hpp>
+#include <boost/serialization/version.hpp>
 #include <string>
+#include <vector>
 
 namespace comm
 {
@@ -51,6 +54,12 @@ namespace comm
 namespace protocol
 {
 
+/// Scheduling classes of prediction requests, most urgent first.
+enum RequestPriority
+{
+    Realtime = 0, Normal, Bulk, NumPriorities
+};
+
 struct Message
 {
     size_t DataOffset;
@@ -59,6 +68,35 @@ struct Message
     double Result;
     std::string Algorithm;
 
+    // results of the component models (ensemble mode only)
+    std::vector<double> Components;
+    std::vector<std::string> ComponentAlgorithms;
+
+    // scheduling class (RequestPriority) and time budget in milliseconds
+    // (0 - no deadline)
+    unsigned Priority;
+    unsigned Deadline;
+
+    // name of the dataset on the server (empty - the server's default one)
+    std::string DatasetId;
+    // reason why the server could not compute the result (empty on success)
+    std::string Error;
+
+    // predict from the newest DataLength values of the default dataset,
+    // the server answers with the DataOffset it has used
+    bool Latest;
+
+    // number of samples aggregated into one value of the predicted series
+    // (1 - the raw series) and the way they are aggregated
+    // (dataprovider::AggregationPyramid::Aggregation); the offsets, length
+    // and horizon count the aggregated values
+    unsigned Resolution;
+    unsigned Aggregation;
+
+    // id of a series of the server's series store (empty - the dataset
+    // given by DatasetId)
+    std::string SeriesId;
+
     Message();
 
     template<typename Archive>
@@ -71,6 +109,40 @@ struct Message
         ar & Horizon;
         ar & Result;
         ar & Algorithm;
+
+        if (version > 0)
+        {
+            ar & Components;
+            ar & ComponentAlgorithms;
+        }
+
+        if (version > 1)
+        {
+            ar & Priority;
+            ar & Deadline;
+        }
+
+        if (version > 2)
+        {
+            ar & DatasetId;
+            ar & Error;
+        }
+
+        if (version > 3)
+        {
+            ar & Latest;
+        }
+
+        if (version > 4)
+        {
+            ar & Resolution;
+            ar & Aggregation;
+        }
+
+        if (version > 5)
+        {
+            ar & SeriesId;
+        }
     }
 };
 
@@ -78,5 +150,7 @@ struct Message
 
 }
 
+BOOST_CLASS_VERSION(comm::protocol::Message, 6)
+
 
 #endif /* PROTOCOL_H_ */
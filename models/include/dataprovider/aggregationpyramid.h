@@ -0,0 +1,96 @@
+/* * Copyright (c) 2010 Dariusz Gadomski <dgadomski@gmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation and/or
+ * other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef AGGREGATIONPYRAMID_H_
+#define AGGREGATIONPYRAMID_H_
+
+#include <dataprovider/dataprovider.h>
+
+#include <string>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+namespace models
+{
+
+namespace dataprovider
+{
+
+/// Coarser versions of a series, built once when the series is loaded.
+/**
+ * Every level aggregates a fixed number of consecutive values (its
+ * factor) into one, in each of the Aggregation ways. Value i of a level
+ * covers the values [i * factor, (i + 1) * factor) of the series, an
+ * incomplete group at the end is left out. A level is computed from the
+ * finest level whose factor divides its own, so a pyramid of 10, 60 and
+ * 300 reads the series only once.
+ *
+ * The levels are ordinary providers, so the models predict on them the
+ * same way as on the series itself.
+ */
+class AggregationPyramid
+{
+public:
+    enum Aggregation
+    {
+        Mean = 0, Sum, Max, NumAggregations
+    };
+
+    typedef boost::shared_ptr<const DataProvider> level_ptr;
+
+    /// Builds the levels of the given factors, the ones below 2 are
+    /// ignored.
+    AggregationPyramid(const DataProvider& data,
+            const std::vector<unsigned>& factors);
+
+    /// Returns the level, an empty pointer if there is no such one.
+    level_ptr getLevel(unsigned factor, unsigned aggregation) const;
+
+    const std::vector<unsigned>& getFactors() const;
+
+    /// Returns the memory taken by all the levels in bytes.
+    size_t getMemoryUsage() const;
+
+    /// Parses the name of an aggregation, returns false for an unknown one.
+    static bool parseAggregation(const std::string& name,
+            Aggregation& aggregation);
+    static const char* getAggregationName(unsigned aggregation);
+
+private:
+    std::vector<unsigned> _factors;
+    // the levels of _factors[i] are _levels[i * NumAggregations + a]
+    std::vector<level_ptr> _levels;
+};
+
+inline
+const std::vector<unsigned>& AggregationPyramid::getFactors() const
+{
+    return _factors;
+}
+
+}
+}
+
+#endif /* AGGREGATIONPYRAMID_H_ */
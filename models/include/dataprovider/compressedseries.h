@@ -0,0 +1,146 @@
+/* * Copyright (c) 2010 Dariusz Gadomski <dgadomski@gmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation and/or
+ * other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef COMPRESSEDSERIES_H_
+#define COMPRESSEDSERIES_H_
+
+#include <dataview.h>
+
+#include <cstddef>
+#include <vector>
+
+#include <boost/cstdint.hpp>
+#include <boost/noncopyable.hpp>
+
+namespace models
+{
+
+namespace dataprovider
+{
+
+/// Series of doubles compressed losslessly with the XOR encoding of
+/// Gorilla.
+/**
+ * Every value is stored as the XOR with the previous one: a single bit if
+ * they are equal, otherwise only the bits between the leading and the
+ * trailing zeros of the XOR, reusing the bounds of the previous value when
+ * the bits fit into them. Neighbouring values of a trace share their sign,
+ * exponent and high mantissa bits, so most of them take well below 64 bits.
+ *
+ * The values are split into blocks of BLOCK_SIZE which start with a raw
+ * value, an index of the bit offsets of the blocks lets a window be decoded
+ * starting at the block holding its first value. Every block also has a
+ * summary of its values, so the statistics of a range only decode the
+ * partial blocks at its ends.
+ */
+class CompressedSeries: private boost::noncopyable
+{
+public:
+    static const size_t BLOCK_SIZE = 128;
+
+    explicit CompressedSeries(const DoubleView& values);
+    /// Takes over the encoded values of another series, e.g. a saved one
+    /// (bits and blocks are left empty). Inconsistent ones give an empty
+    /// series.
+    CompressedSeries(std::vector<boost::uint64_t>& bits,
+            std::vector<boost::uint64_t>& blocks, size_t count);
+
+    size_t getCount() const;
+    /// The encoded values and the bit offsets of the blocks in them, which
+    /// restore the series.
+    const std::vector<boost::uint64_t>& getBits() const;
+    const std::vector<boost::uint64_t>& getBlocks() const;
+
+    double getValue(size_t idx) const;
+    /// Decodes the values [idx, idx + size) into output.
+    void decode(size_t idx, size_t size, double* output) const;
+
+    /// Range statistics, the ones of an empty range are NaN.
+    double getMean(size_t idx, size_t size) const;
+    /// Returns the population variance of the range.
+    double getVariance(size_t idx, size_t size) const;
+    double getMin(size_t idx, size_t size) const;
+    double getMax(size_t idx, size_t size) const;
+
+    /// Returns the memory taken by the encoded values, the index and the
+    /// summaries in bytes.
+    size_t getMemoryUsage() const;
+    /// Returns the memory the values would take as doubles divided by
+    /// getMemoryUsage().
+    double getCompressionRatio() const;
+
+private:
+    /// Statistics of consecutive values.
+    struct Summary
+    {
+        Summary();
+        /// Summarizes the values in two passes.
+        Summary(const double* values, size_t size);
+
+        /// Adds the values following the ones summarized, the deviations
+        /// are combined as in the parallel variance of Chan et al.
+        void merge(const Summary& other);
+
+        size_t Count;
+        double Mean;
+        // sum of the squared deviations from the mean
+        double Deviation;
+        double Min;
+        double Max;
+    };
+
+    Summary summarize(size_t idx, size_t size) const;
+    void summarizeBlocks(const double* values);
+
+private:
+    std::vector<boost::uint64_t> _bits;
+    // bit offset of every block in _bits
+    std::vector<boost::uint64_t> _blocks;
+    // summary of every block
+    std::vector<Summary> _summaries;
+    size_t _count;
+};
+
+inline
+size_t CompressedSeries::getCount() const
+{
+    return _count;
+}
+
+inline
+const std::vector<boost::uint64_t>& CompressedSeries::getBits() const
+{
+    return _bits;
+}
+
+inline
+const std::vector<boost::uint64_t>& CompressedSeries::getBlocks() const
+{
+    return _blocks;
+}
+
+}
+}
+
+#endif /* COMPRESSEDSERIES_H_ */
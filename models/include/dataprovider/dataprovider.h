@@ -25,29 +25,126 @@
 #ifndef DATAPROVIDER_H_
 #define DATAPROVIDER_H_
 
+#include <dataview.h>
+
 #include <string>
 #include <vector>
 
+#include <boost/shared_ptr.hpp>
+
 namespace models
 {
 
 namespace dataprovider
 {
 
+class CompressedSeries;
+class RangeIndex;
+class SeriesFile;
+
+/// Single time series, either parsed from a text file (one value per line)
+/// or memory mapped from a binary series file.
+/**
+ * A series file is only mapped, so it may be larger than the memory: the
+ * page cache keeps the recently used parts of it and prefetch() reads the
+ * ones about to be used ahead.
+ *
+ * A provider may also hold just a window of a longer series (a snapshot of
+ * a live stream), the values are then addressed by their index in the
+ * whole series, starting at getFirstIndex().
+ *
+ * The values may be kept in single precision, which halves their memory
+ * and the bytes moved by the window scans; they are read as doubles
+ * either way.
+ *
+ * Long series may also be compressed losslessly in blocks, a window is
+ * then decoded into a buffer of the thread, which its view keeps while it
+ * is held; the range statistics come from summaries of the blocks.
+ */
 class DataProvider
 {
 public:
-    DataProvider(const std::string& filename);
+    /// Precision of the values held by the provider, compressed values
+    /// keep the double precision.
+    enum Precision
+    {
+        DoublePrecision, SinglePrecision, Compressed
+    };
+
+    /// Loads the file. The values of a text file are kept in the given
+    /// precision, a series file has the precision it was written with.
+    DataProvider(const std::string& filename, Precision precision =
+            DoublePrecision);
+    /// Creates the provider from already parsed values of the file, kept in
+    /// the given precision.
+    DataProvider(const std::string& filename, const std::vector<double>& items,
+            Precision precision = DoublePrecision);
+    /// Creates a window of a series, items[0] is the value at index first.
+    /// The values are taken over (items is left empty). The maximum of the
+    /// whole series is given, as the nets are scaled by it. A window is
+    /// usually used by a single computation, so it is not indexed.
+    DataProvider(const std::string& filename, std::vector<double>& items,
+            size_t first, double maxValue);
+    /// Creates the provider of values owned by storage, e.g. a column of a
+    /// table. They are neither copied nor indexed, the copies of the
+    /// provider share the storage.
+    DataProvider(const std::string& filename, const DataView& values,
+            const boost::shared_ptr<const void>& storage);
+    /// Creates the provider of already compressed values.
+    DataProvider(const std::string& filename,
+            const boost::shared_ptr<const CompressedSeries>& values);
+    DataProvider(const DataProvider& other);
     ~DataProvider();
 
+    DataProvider& operator=(const DataProvider& other);
+
+    const std::string& getFilename() const;
+    std::vector<double> getItems() const;
+    Precision getPrecision() const;
+
+    /// Returns the index following the last value, which is the number of
+    /// values unless the provider holds a window.
     size_t getDataSize() const;
+    size_t getFirstIndex() const;
 
     double getData(int idx) const;
     std::vector<double> getDataVector(int idx, size_t size) const;
+    /// Returns the values without copying them, valid as long as the
+    /// provider.
+    DataView getView(int idx, size_t size) const;
 
+    /// Range statistics, answered by the index built on load in constant
+    /// time. Mapped series files and single precision values are not
+    /// indexed (the index would take more memory than the values), neither
+    /// are windows; their ranges are scanned. Compressed values use the
+    /// summaries of their blocks.
     double getAverage(int idx, size_t size) const;
+    double getVariance(int idx, size_t size) const;
+    double getMinValue(int idx, size_t size) const;
+    double getMaxValue(int idx, size_t size) const;
+
     double getMaxValue() const;
 
+    /// Returns the memory taken by the values and the index in bytes.
+    size_t getMemoryUsage() const;
+    /// Returns the memory the values would take as doubles divided by the
+    /// one they take, 1 unless they are compressed.
+    double getCompressionRatio() const;
+    /// Returns true if the values are a mapped series file.
+    bool isMapped() const;
+    /// Returns the compressed values, a null pointer unless the provider
+    /// holds compressed values.
+    boost::shared_ptr<const CompressedSeries> getCompressedSeries() const;
+
+    /// Builds a private copy of the index shared with the provider this one
+    /// was copied from, so that a replica on another NUMA node reads its
+    /// own local memory. Does nothing if the provider has no index.
+    void rebuildIndex();
+
+    /// Starts reading the values [idx, idx + size) of a mapped series file
+    /// from the disk in the background, does nothing for the other ones.
+    void prefetch(int idx, size_t size) const;
+
     static double getMeanSquareError(const std::vector<double>& expected,
             const std::vector<double>& actual);
 
@@ -64,12 +161,96 @@ public:
 
 private:
     bool loadFromFile(const std::string& filename);
+    bool mapSeriesFile(const std::string& filename);
+    void storeItems(Precision precision);
+    void updateView();
+    void buildIndex();
+    double decodeValue(int idx) const;
+    DataView decodeView(int idx, size_t size) const;
 
 private:
     std::string _filename;
     std::vector<double> _items;
+    // set instead of _items for single precision values
+    std::vector<float> _floatItems;
+    // set instead of _items for binary series files, shared by the copies
+    boost::shared_ptr<SeriesFile> _series;
+    // set instead of _items for compressed values, shared by the copies
+    boost::shared_ptr<const CompressedSeries> _compressed;
+    // set instead of _items for values owned by another object, shared by
+    // the copies
+    boost::shared_ptr<const void> _storage;
+    // values of one of the above, only one of the pointers is set
+    const double* _data;
+    const float* _floats;
+    size_t _size;
+    // index of _data[0] in the series
+    size_t _first;
+    boost::shared_ptr<const RangeIndex> _index;
+    double _maxValue;
 };
 
+inline
+const std::string& DataProvider::getFilename() const
+{
+    return _filename;
+}
+
+inline
+DataProvider::Precision DataProvider::getPrecision() const
+{
+    if (_compressed)
+    {
+        return Compressed;
+    }
+    return _floats ? SinglePrecision : DoublePrecision;
+}
+
+inline
+double DataProvider::getData(int idx) const
+{
+    if (_compressed)
+    {
+        return decodeValue(idx);
+    }
+    return _floats ? _floats[idx - _first] : _data[idx - _first];
+}
+
+inline
+DataView DataProvider::getView(int idx, size_t size) const
+{
+    if (_compressed)
+    {
+        return decodeView(idx, size);
+    }
+    return _floats ? DataView(_floats + idx - _first, size) : DataView(_data
+            + idx - _first, size);
+}
+
+inline
+bool DataProvider::isMapped() const
+{
+    return _series.get() != 0;
+}
+
+inline
+boost::shared_ptr<const CompressedSeries> DataProvider::getCompressedSeries() const
+{
+    return _compressed;
+}
+
+inline
+size_t DataProvider::getDataSize() const
+{
+    return _first + _size;
+}
+
+inline
+size_t DataProvider::getFirstIndex() const
+{
+    return _first;
+}
+
 }
 }
 
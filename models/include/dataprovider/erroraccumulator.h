@@ -0,0 +1,85 @@
+/* * Copyright (c) 2010 Dariusz Gadomski <dgadomski@gmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation and/or
+ * other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef ERRORACCUMULATOR_H_
+#define ERRORACCUMULATOR_H_
+
+#include <cstddef>
+
+namespace models
+{
+
+namespace dataprovider
+{
+
+/// Errors of one column of predictions against the expected values.
+struct ErrorMetrics
+{
+    ErrorMetrics();
+
+    double MeanSquareError;
+    double NormalizedMeanSquareError;
+    double SignalToErrorRatio;
+};
+
+/// Error metrics of a stream of predictions, updated with every pair of
+/// values in constant memory.
+/**
+ * The means are updated in Welford's manner (the new value moves the mean
+ * by its distance divided by the count), so the metrics are available at
+ * any point of a run and do not lose precision on long runs the way the
+ * plain sums do.
+ */
+class ErrorAccumulator
+{
+public:
+    ErrorAccumulator();
+
+    void add(double expected, double actual);
+
+    size_t getCount() const;
+
+    /// Returns the metrics of the pairs added so far, with the same
+    /// definitions as the functions of the DataProvider.
+    ErrorMetrics getMetrics() const;
+
+private:
+    size_t _count;
+    /// Mean of the values and the sum of their squared deviations from it.
+    double _mean;
+    double _deviation;
+    double _meanSquare;
+    double _meanSquareError;
+};
+
+inline size_t ErrorAccumulator::getCount() const
+{
+    return _count;
+}
+
+}
+
+}
+
+#endif /* ERRORACCUMULATOR_H_ */
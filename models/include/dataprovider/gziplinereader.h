@@ -0,0 +1,95 @@
+/* * Copyright (c) 2010 Dariusz Gadomski <dgadomski@gmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation and/or
+ * other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef GZIPLINEREADER_H_
+#define GZIPLINEREADER_H_
+
+#include <deque>
+#include <string>
+
+#include <boost/noncopyable.hpp>
+#include <boost/thread.hpp>
+
+namespace models
+{
+
+namespace dataprovider
+{
+
+/// Streaming decompression of gzip compressed text.
+/**
+ * A background thread inflates the compressed buffer into blocks which end
+ * at line boundaries and queues them, so the consumer parses a block while
+ * the following ones are being inflated. At most a few blocks are queued,
+ * the whole decompressed text is never held in memory. Concatenated gzip
+ * members are read one after another like gunzip does.
+ *
+ * Without zlib (HAVE_ZLIB undefined) every compressed buffer fails.
+ */
+class GzipLineReader: private boost::noncopyable
+{
+public:
+    /// Starts inflating [data, data + size), the buffer must outlive the
+    /// reader.
+    GzipLineReader(const char* data, size_t size);
+    ~GzipLineReader();
+
+    /// Takes the next block of whole lines (the last one may lack the line
+    /// break), returns false once all of them have been taken.
+    bool next(std::string& block);
+
+    /// Returns true if the data could not be inflated, valid after next()
+    /// returned false.
+    bool failed() const;
+
+    /// Returns true if the buffer starts with the gzip magic number.
+    static bool isCompressed(const char* data, size_t size);
+
+private:
+    static const size_t BLOCK_SIZE = 1 << 20;
+    static const size_t MAX_QUEUED_BLOCKS = 4;
+
+    void inflate();
+    // hands a block over to the consumer, returns false if it stopped
+    bool push(std::string& block);
+    void finish(bool failed);
+
+private:
+    const char *_data;
+    size_t _size;
+
+    mutable boost::mutex _mutex;
+    boost::condition_variable _blockAvailable;
+    boost::condition_variable _spaceAvailable;
+    std::deque<std::string> _blocks;
+    bool _done;
+    bool _failed;
+    bool _stopping;
+    boost::thread _thread;
+};
+
+}
+}
+
+#endif /* GZIPLINEREADER_H_ */
@@ -25,6 +25,9 @@
 #ifndef MULTIDATAPROVIDER_H_
 #define MULTIDATAPROVIDER_H_
 
+#include <dataprovider/dataprovider.h>
+#include <dataview.h>
+
 #include <string>
 #include <vector>
 
@@ -34,16 +37,34 @@ namespace models
 namespace dataprovider
 {
 
+/// Series of rows with several values each (one row per line of the file).
+/**
+ * The rows are kept in a single row-major buffer, so a row or a part of it
+ * is a contiguous view and a column is a view with the stride of a row.
+ * All the rows have the width of the first one, a file with rows of
+ * different widths is rejected. Like in the DataProvider, the values may
+ * be kept in single precision.
+ */
 class MultiDataProvider
 {
 public:
-    MultiDataProvider(const std::string& filename);
+    MultiDataProvider(const std::string& filename,
+            DataProvider::Precision precision = DataProvider::DoublePrecision);
     ~MultiDataProvider();
 
     size_t getDataSize() const;
+    size_t getColumnCount() const;
 
     double getValue(int idx, size_t pos) const;
 
+    DataView getRowView(int idx) const;
+    /// Returns the values [start, start + size) of the row idx.
+    DataView getRowView(int idx, size_t start, size_t size) const;
+    /// Returns the values of the column pos in the rows [idx, idx + size).
+    StridedView getColumnView(size_t pos, int idx, size_t size) const;
+    /// Returns the rows [idx, idx + size) as one contiguous view.
+    DataView getRowsView(int idx, size_t size) const;
+
     std::vector<double> getData(int idx) const;
 
     std::vector<double> getDataSubvector(int idx, size_t start, size_t size) const;
@@ -51,15 +72,65 @@ public:
     std::vector<std::vector<double> > getDataVector(int idx, size_t size) const;
 
     double getMaxValue() const;
+    /// Returns the maximum of the rows [idx, idx + size).
+    double getMaxValue(int idx, size_t size) const;
 
 private:
-    bool loadFromFile(const std::string& filename);
+    bool loadFromFile(const std::string& filename,
+            DataProvider::Precision precision);
 
 private:
     std::string _filename;
-    std::vector<std::vector<double> > _items;
+    // only one of them is filled
+    std::vector<double> _values;
+    std::vector<float> _floatValues;
+    size_t _rows;
+    size_t _columns;
+    double _maxValue;
 };
 
+inline size_t MultiDataProvider::getDataSize() const
+{
+    return _rows;
+}
+
+inline size_t MultiDataProvider::getColumnCount() const
+{
+    return _columns;
+}
+
+inline double MultiDataProvider::getValue(int idx, size_t pos) const
+{
+    size_t offset = idx * _columns + pos;
+    return _floatValues.empty() ? _values[offset] : _floatValues[offset];
+}
+
+inline DataView MultiDataProvider::getRowView(int idx) const
+{
+    return getRowView(idx, 0, _columns);
+}
+
+inline DataView MultiDataProvider::getRowView(int idx, size_t start,
+        size_t size) const
+{
+    size_t offset = idx * _columns + start;
+    return _floatValues.empty() ? DataView(&_values[offset], size)
+            : DataView(&_floatValues[offset], size);
+}
+
+inline StridedView MultiDataProvider::getColumnView(size_t pos, int idx,
+        size_t size) const
+{
+    size_t offset = idx * _columns + pos;
+    return _floatValues.empty() ? StridedView(&_values[offset], size,
+            _columns) : StridedView(&_floatValues[offset], size, _columns);
+}
+
+inline DataView MultiDataProvider::getRowsView(int idx, size_t size) const
+{
+    return getRowView(idx, 0, size * _columns);
+}
+
 }
 }
 
@@ -0,0 +1,108 @@
+/* * Copyright (c) 2010 Dariusz Gadomski <dgadomski@gmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation and/or
+ * other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef PREDICTIONTABLE_H_
+#define PREDICTIONTABLE_H_
+
+#include <mappedfile.h>
+
+#include <string>
+#include <vector>
+
+#include <boost/cstdint.hpp>
+
+namespace models
+{
+
+namespace dataprovider
+{
+
+/// On-disk header of a prediction table file.
+struct PredictionTableHeader
+{
+    PredictionTableHeader();
+
+    char Magic[8];
+    boost::uint32_t Version;
+    char Algorithm[20];
+    boost::uint64_t DatasetSize;
+    boost::uint64_t DataLength;
+    boost::uint64_t Horizon;
+    boost::uint64_t Step;
+    boost::uint64_t FirstOffset;
+    boost::uint64_t Count;
+};
+
+/// Precomputed predictions of one model for a fixed (length, horizon, step).
+/**
+ * The file consists of a PredictionTableHeader followed by Count doubles.
+ * Value i is the prediction at the given horizon for the window starting
+ * at FirstOffset + i * Step. The table is memory mapped, so several
+ * servers share a single copy of it.
+ */
+class PredictionTable
+{
+public:
+    static const char MAGIC[8];
+    static const boost::uint32_t VERSION = 1;
+
+    explicit PredictionTable(const std::string& filename);
+
+    bool isValid() const;
+
+    const PredictionTableHeader& getHeader() const;
+    std::string getAlgorithm() const;
+
+    /// Returns true and stores the precomputed value if the table covers
+    /// the requested window.
+    bool lookup(size_t offset, size_t length, size_t horizon,
+            double& result) const;
+
+    static bool write(const std::string& filename,
+            const PredictionTableHeader& header,
+            const std::vector<double>& predictions);
+
+private:
+    std::string _filename;
+    MappedFile _file;
+    const PredictionTableHeader* _header;
+    const double* _values;
+};
+
+inline
+bool PredictionTable::isValid() const
+{
+    return _header != 0;
+}
+
+inline
+const PredictionTableHeader& PredictionTable::getHeader() const
+{
+    return *_header;
+}
+
+}
+}
+
+#endif /* PREDICTIONTABLE_H_ */
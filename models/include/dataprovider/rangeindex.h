@@ -0,0 +1,109 @@
+/* * Copyright (c) 2010 Dariusz Gadomski <dgadomski@gmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation and/or
+ * other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef RANGEINDEX_H_
+#define RANGEINDEX_H_
+
+#include <cstddef>
+#include <vector>
+
+namespace models
+{
+
+namespace dataprovider
+{
+
+/// Index answering range statistics of a series.
+/**
+ * Mean and variance come in constant time from prefix sums of the values
+ * and of their squares, both taken relative to the mean of the whole
+ * series so that the subtraction of two prefixes does not cancel out the
+ * variance of a window. These two arrays take twice the memory of the
+ * values.
+ *
+ * Minimum and maximum come from the extremes of blocks of BLOCK_SIZE
+ * values and from sparse tables over superblocks of getSpan() blocks. The
+ * span is at least log2 of the number of blocks, so a sparse table has no
+ * more entries than there are blocks and the index stays linear: at most
+ * 2 * (n + 1) + 4 * ceil(n / BLOCK_SIZE) doubles. A query scans the partial
+ * blocks and superblocks at the ends of the range, O(BLOCK_SIZE + log n).
+ *
+ * The index does not own the values, they are passed to the queries which
+ * need them. The statistics of an empty range are NaN.
+ */
+class RangeIndex
+{
+public:
+    static const size_t BLOCK_SIZE = 16;
+
+    RangeIndex(const double* values, size_t size);
+
+    double getMean(size_t idx, size_t size) const;
+    /// Returns the population variance of the range.
+    double getVariance(size_t idx, size_t size) const;
+
+    double getMin(const double* values, size_t idx, size_t size) const;
+    double getMax(const double* values, size_t idx, size_t size) const;
+
+    /// Returns the number of blocks in a superblock.
+    size_t getSpan() const;
+
+    /// Returns the memory taken by the index in bytes.
+    size_t getMemoryUsage() const;
+
+private:
+    typedef std::vector<std::vector<double> > SparseTable;
+
+    template<typename Better>
+    void buildExtremes(const double* values, size_t size,
+            std::vector<double>& blocks, SparseTable& table, Better better);
+
+    template<typename Better>
+    double query(const double* values, size_t idx, size_t size,
+            const std::vector<double>& blocks, const SparseTable& table,
+            Better better) const;
+
+private:
+    double _offset;
+    // _sums[i] is the sum of (value - _offset) over the first i values
+    std::vector<double> _sums;
+    std::vector<double> _squares;
+    size_t _span;
+    // extremes of every block
+    std::vector<double> _blockMinima;
+    std::vector<double> _blockMaxima;
+    // level k holds the extreme of 2^k superblocks starting at every one
+    SparseTable _minima;
+    SparseTable _maxima;
+};
+
+inline size_t RangeIndex::getSpan() const
+{
+    return _span;
+}
+
+}
+}
+
+#endif /* RANGEINDEX_H_ */
@@ -0,0 +1,138 @@
+/* * Copyright (c) 2010 Dariusz Gadomski <dgadomski@gmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation and/or
+ * other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SERIESFILE_H_
+#define SERIESFILE_H_
+
+#include <mappedfile.h>
+
+#include <string>
+#include <vector>
+
+#include <boost/cstdint.hpp>
+
+namespace models
+{
+
+namespace dataprovider
+{
+
+/// On-disk header of a binary time series file.
+struct SeriesFileHeader
+{
+    SeriesFileHeader();
+
+    char Magic[8];
+    boost::uint32_t Version;
+    boost::uint32_t ValueSize;
+    boost::uint64_t Count;
+    double Min;
+    double Max;
+    double Mean;
+};
+
+/// Time series stored as packed doubles (or floats, see ValueSize) behind a
+/// SeriesFileHeader.
+/**
+ * The file is memory mapped read-only, so opening it costs nothing
+ * regardless of its size and all processes reading it share the pages
+ * in the page cache. The statistics in the header spare a pass over the
+ * data. Files are written by the convertdata tool.
+ */
+class SeriesFile
+{
+public:
+    static const char MAGIC[8];
+    static const boost::uint32_t VERSION = 1;
+
+    explicit SeriesFile(const std::string& filename);
+
+    bool isValid() const;
+
+    const SeriesFileHeader& getHeader() const;
+    /// Returns the values of a double precision file, 0 for the other ones.
+    const double* getValues() const;
+    /// Returns the values of a single precision file, 0 for the other ones.
+    const float* getFloatValues() const;
+    size_t getCount() const;
+
+    /// Starts reading the values [idx, idx + count) in the background.
+    void prefetch(size_t idx, size_t count) const;
+
+    /// Returns true if the file starts with the series file magic.
+    static bool isSeriesFile(const std::string& filename);
+
+    /// Writes the values, rounded to floats if singlePrecision is set.
+    static bool write(const std::string& filename,
+            const std::vector<double>& values, bool singlePrecision = false);
+
+private:
+    std::string _filename;
+    MappedFile _file;
+    const SeriesFileHeader* _header;
+    const double* _values;
+    const float* _floatValues;
+};
+
+inline
+bool SeriesFile::isValid() const
+{
+    return _header != 0;
+}
+
+inline
+const SeriesFileHeader& SeriesFile::getHeader() const
+{
+    return *_header;
+}
+
+inline
+const double* SeriesFile::getValues() const
+{
+    return _values;
+}
+
+inline
+const float* SeriesFile::getFloatValues() const
+{
+    return _floatValues;
+}
+
+inline
+size_t SeriesFile::getCount() const
+{
+    return _header ? _header->Count : 0;
+}
+
+inline
+void SeriesFile::prefetch(size_t idx, size_t count) const
+{
+    _file.prefetch(sizeof(SeriesFileHeader) + idx * _header->ValueSize, count
+            * _header->ValueSize);
+}
+
+}
+}
+
+#endif /* SERIESFILE_H_ */
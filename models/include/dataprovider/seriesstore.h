@@ -0,0 +1,112 @@
+/* * Copyright (c) 2010 Dariusz Gadomski <dgadomski@gmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation and/or
+ * other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SERIESSTORE_H_
+#define SERIESSTORE_H_
+
+#include <dataprovider/dataprovider.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+namespace models
+{
+
+namespace dataprovider
+{
+
+/// Many series sharing one time axis, e.g. the traffic of all the links of
+/// a network, addressed by their ids.
+/**
+ * The file has a line per time step with a value of every series in it.
+ * The optional first line "# id1 id2 ..." names the series, otherwise they
+ * are named by their column numbers starting at 0. A file with lines of
+ * different widths is rejected.
+ *
+ * The values are parsed into the flat buffers of the parser threads and
+ * copied once into a single buffer holding the columns one after another,
+ * in the precision of the store. A series is a provider viewing its
+ * column, so a window of it is contiguous and its maximum (which scales
+ * the nets) does not depend on the other series. The series are not
+ * indexed, their range statistics are scanned. Compressed series are
+ * encoded column by column instead.
+ */
+class SeriesStore
+{
+public:
+    typedef boost::shared_ptr<const DataProvider> series_ptr;
+
+    explicit SeriesStore(const std::string& filename,
+            DataProvider::Precision precision = DataProvider::DoublePrecision);
+
+    /// Returns the series, an empty pointer for an unknown id.
+    series_ptr getSeries(const std::string& id) const;
+
+    const std::vector<std::string>& getIds() const;
+    size_t getSeriesCount() const;
+    /// Returns the number of time steps of every series.
+    size_t getLength() const;
+
+    /// Returns the memory taken by the series in bytes.
+    size_t getMemoryUsage() const;
+
+private:
+    bool loadFromFile(const std::string& filename,
+            DataProvider::Precision precision);
+    std::string getName(size_t column) const;
+    static std::vector<std::string> readIds(const std::string& filename);
+
+private:
+    std::string _filename;
+    std::vector<std::string> _ids;
+    std::map<std::string, size_t> _index;
+    std::vector<series_ptr> _series;
+    size_t _length;
+};
+
+inline
+const std::vector<std::string>& SeriesStore::getIds() const
+{
+    return _ids;
+}
+
+inline
+size_t SeriesStore::getSeriesCount() const
+{
+    return _series.size();
+}
+
+inline
+size_t SeriesStore::getLength() const
+{
+    return _length;
+}
+
+}
+}
+
+#endif /* SERIESSTORE_H_ */
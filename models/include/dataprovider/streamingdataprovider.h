@@ -0,0 +1,144 @@
+/* * Copyright (c) 2010 Dariusz Gadomski <dgadomski@gmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation and/or
+ * other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef STREAMINGDATAPROVIDER_H_
+#define STREAMINGDATAPROVIDER_H_
+
+#include <dataprovider/dataprovider.h>
+
+#include <string>
+#include <vector>
+
+#include <boost/atomic.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread.hpp>
+
+namespace models
+{
+
+namespace dataprovider
+{
+
+/// Time series which keeps growing while it is served.
+/**
+ * A background thread follows a text file the values are appended to (or
+ * a pipe) and stores the values in a ring buffer of fixed capacity, so the
+ * oldest ones are dropped once it is full. Values are addressed by their
+ * index in the whole stream.
+ *
+ * There is a single writer and readers take no lock: a reader copies the
+ * values and checks afterwards that the writer has not reached them in the
+ * meantime (the slot being written is never handed out).
+ */
+class StreamingDataProvider: private boost::noncopyable
+{
+public:
+    /// The file "-" is the standard input.
+    StreamingDataProvider(const std::string& filename, size_t capacity);
+    ~StreamingDataProvider();
+
+    /// Reads the current contents of the file and starts following it.
+    /// Returns false if the file cannot be opened.
+    bool start();
+    void stop();
+
+    /// Appends a value - only called by the writer.
+    void append(double value);
+
+    const std::string& getFilename() const;
+    size_t getCapacity() const;
+
+    /// Returns the number of values appended so far, which is the index
+    /// following the newest one.
+    size_t getCount() const;
+    /// Returns the index of the oldest value which can still be read.
+    size_t getFirstIndex() const;
+    /// Returns the maximum of all values appended so far.
+    double getMaxValue() const;
+
+    /// Copies the values [idx, idx + size) to output. Returns false if the
+    /// range has not been appended yet or has already been overwritten.
+    bool getDataVector(size_t idx, size_t size,
+            std::vector<double>& output) const;
+
+    /// Returns a copy of the values [idx, idx + size) as a window provider
+    /// (without an index) or a null pointer if the range cannot be read.
+    boost::shared_ptr<DataProvider> getSnapshot(size_t idx, size_t size) const;
+
+private:
+    static const unsigned POLL_INTERVAL = 100; // ms
+
+    size_t getFirstIndex(size_t count) const;
+
+    void follow();
+    long readAvailable();
+    void parseLines();
+    void checkRotated();
+    bool open();
+
+private:
+    std::string _filename;
+    std::vector<double> _buffer;
+    boost::atomic<size_t> _count;
+    boost::atomic<double> _maxValue;
+    boost::atomic<bool> _stopping;
+
+    // state of the writer
+    int _fd;
+    bool _regularFile;
+    size_t _position;
+    // incomplete last line
+    std::string _pending;
+    boost::thread _thread;
+};
+
+inline
+const std::string& StreamingDataProvider::getFilename() const
+{
+    return _filename;
+}
+
+inline
+size_t StreamingDataProvider::getCapacity() const
+{
+    return _buffer.size();
+}
+
+inline
+size_t StreamingDataProvider::getCount() const
+{
+    return _count.load(boost::memory_order_acquire);
+}
+
+inline
+double StreamingDataProvider::getMaxValue() const
+{
+    return _maxValue.load(boost::memory_order_relaxed);
+}
+
+}
+}
+
+#endif /* STREAMINGDATAPROVIDER_H_ */
@@ -0,0 +1,102 @@
+/* * Copyright (c) 2010 Dariusz Gadomski <dgadomski@gmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation and/or
+ * other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef TEXTPARSER_H_
+#define TEXTPARSER_H_
+
+#include <string>
+#include <vector>
+
+namespace models
+{
+
+namespace dataprovider
+{
+
+/// Values of consecutive rows of a table, one row after another.
+struct TableChunk
+{
+    TableChunk();
+
+    std::vector<double> Values;
+    /// Number of values in a row, 0 if the chunk has no rows.
+    size_t Width;
+    /// Set if a row has a different number of values than the first one,
+    /// the rest of the chunk is not parsed then.
+    bool Ragged;
+};
+
+/// Parser of text datasets.
+/**
+ * The file is memory mapped and split at line boundaries into chunks which
+ * are parsed on separate threads and concatenated in order. Numbers are
+ * parsed without a stream; the rare tokens which cannot be converted
+ * exactly that way are handed to a string stream, so the values are the
+ * same as the ones read by operator>>.
+ *
+ * Gzip compressed files are recognized by their magic number and inflated
+ * on a separate thread while the inflated blocks are parsed, without a
+ * temporary file.
+ */
+class TextParser
+{
+public:
+    /// Uses as many threads as there are cores when threads is 0.
+    explicit TextParser(unsigned threads = 0);
+
+    /// Reads the first number of every line, lines without one are skipped.
+    bool parseValues(const std::string& filename,
+            std::vector<double>& values) const;
+
+    /// Reads every line as a row of whitespace separated numbers into the
+    /// flat buffers of the chunks parsed by the threads. A row ends at the
+    /// first token which is not a number, the lines without numbers are
+    /// skipped. Returns false if the rows differ in width, which is set
+    /// otherwise.
+    bool parseTable(const std::string& filename,
+            std::vector<TableChunk>& chunks, size_t& width) const;
+
+    /// Returns the first line of the file (without the line break), which
+    /// may be compressed.
+    static std::string readFirstLine(const std::string& filename);
+
+    /// Reads the first number of the line [begin, end), returns false if
+    /// there is none.
+    static bool parseLine(const char* begin, const char* end, double& value);
+
+    /// Converts the token [begin, end), returns false if it does not start
+    /// with a number.
+    static bool parseNumber(const char* begin, const char* end, double& value);
+
+private:
+    unsigned getChunkCount(size_t size) const;
+
+private:
+    unsigned _threads;
+};
+
+}
+}
+
+#endif /* TEXTPARSER_H_ */
@@ -0,0 +1,358 @@
+/* * Copyright (c) 2010 Dariusz Gadomski <dgadomski@gmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation and/or
+ * other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DATAVIEW_H_
+#define DATAVIEW_H_
+
+#include <cstddef>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+namespace models
+{
+
+/// Read-only view of consecutive values of type T owned by someone else.
+/**
+ * The view is only valid as long as the storage it points to. A vector
+ * converts to a view implicitly.
+ */
+template<typename T>
+class BasicDataView
+{
+public:
+    typedef T value_type;
+    typedef const T* const_iterator;
+
+    BasicDataView() :
+        _begin(0), _size(0)
+    {
+    }
+
+    BasicDataView(const T* begin, size_t size) :
+        _begin(begin), _size(size)
+    {
+    }
+
+    BasicDataView(const std::vector<T>& values) :
+        _begin(values.empty() ? 0 : &values[0]), _size(values.size())
+    {
+    }
+
+    const_iterator begin() const
+    {
+        return _begin;
+    }
+
+    const_iterator end() const
+    {
+        return _begin + _size;
+    }
+
+    size_t size() const
+    {
+        return _size;
+    }
+
+    bool empty() const
+    {
+        return _size == 0;
+    }
+
+    T operator[](size_t idx) const
+    {
+        return _begin[idx];
+    }
+
+    T back() const
+    {
+        return _begin[_size - 1];
+    }
+
+    /// Returns the part of the view starting at idx.
+    BasicDataView subview(size_t idx, size_t size) const
+    {
+        return BasicDataView(_begin + idx, size);
+    }
+
+private:
+    const T *_begin;
+    size_t _size;
+};
+
+typedef BasicDataView<double> DoubleView;
+typedef BasicDataView<float> FloatView;
+
+/// Read-only view of consecutive values owned by someone else, usually a
+/// window of a dataset.
+/**
+ * The view is only valid as long as the storage it points to, so it is
+ * passed down to computations and never kept. A vector converts to a view
+ * implicitly.
+ *
+ * The values may be stored in single precision to halve the memory of
+ * large datasets, the models compute in double precision either way. The
+ * storage type is only known at run time, so the view gives no access to
+ * single values: the code reading it checks isSinglePrecision() once and
+ * walks doubles() or floats(), which read the values without a branch.
+ *
+ * Values decoded from a compressed dataset are owned by the view (and the
+ * copies of it) instead.
+ */
+class DataView
+{
+public:
+    DataView() :
+        _singlePrecision(false)
+    {
+    }
+
+    DataView(const double* begin, size_t size) :
+        _doubles(begin, size), _singlePrecision(false)
+    {
+    }
+
+    DataView(const float* begin, size_t size) :
+        _floats(begin, size), _singlePrecision(true)
+    {
+    }
+
+    DataView(const std::vector<double>& values) :
+        _doubles(values), _singlePrecision(false)
+    {
+    }
+
+    /// Creates a view owning the values.
+    explicit DataView(const boost::shared_ptr<const std::vector<double> >& values) :
+        _doubles(*values), _singlePrecision(false), _owned(values)
+    {
+    }
+
+    size_t size() const
+    {
+        return _singlePrecision ? _floats.size() : _doubles.size();
+    }
+
+    bool empty() const
+    {
+        return size() == 0;
+    }
+
+    /// Returns true if the values are stored in single precision.
+    bool isSinglePrecision() const
+    {
+        return _singlePrecision;
+    }
+
+    /// The values stored in double precision, empty if they are not.
+    const DoubleView& doubles() const
+    {
+        return _doubles;
+    }
+
+    /// The values stored in single precision, empty if they are not.
+    const FloatView& floats() const
+    {
+        return _floats;
+    }
+
+    /// Replaces the contents of output with the values, its storage is
+    /// reused.
+    void copyTo(std::vector<double>& output) const
+    {
+        if (_singlePrecision)
+        {
+            output.assign(_floats.begin(), _floats.end());
+        }
+        else
+        {
+            output.assign(_doubles.begin(), _doubles.end());
+        }
+    }
+
+    /// Returns the part of the view starting at idx.
+    DataView subview(size_t idx, size_t size) const
+    {
+        DataView view(*this);
+        if (_singlePrecision)
+        {
+            view._floats = _floats.subview(idx, size);
+        }
+        else
+        {
+            view._doubles = _doubles.subview(idx, size);
+        }
+        return view;
+    }
+
+private:
+    DoubleView _doubles;
+    FloatView _floats;
+    bool _singlePrecision;
+    // set if the view owns the values
+    boost::shared_ptr<const std::vector<double> > _owned;
+};
+
+/// Read-only view of values of type T lying at a fixed distance from each
+/// other, e.g. a column of a row-major matrix.
+template<typename T>
+class BasicStridedView
+{
+public:
+    BasicStridedView() :
+        _begin(0), _size(0), _stride(1)
+    {
+    }
+
+    BasicStridedView(const T* begin, size_t size, size_t stride) :
+        _begin(begin), _size(size), _stride(stride)
+    {
+    }
+
+    size_t size() const
+    {
+        return _size;
+    }
+
+    bool empty() const
+    {
+        return _size == 0;
+    }
+
+    T operator[](size_t idx) const
+    {
+        return _begin[idx * _stride];
+    }
+
+    T back() const
+    {
+        return (*this)[_size - 1];
+    }
+
+    /// Returns the part of the view starting at idx.
+    BasicStridedView subview(size_t idx, size_t size) const
+    {
+        return BasicStridedView(_begin + idx * _stride, size, _stride);
+    }
+
+    /// Appends the values to output.
+    void appendTo(std::vector<double>& output) const
+    {
+        for (size_t i = 0; i < _size; ++i)
+        {
+            output.push_back(_begin[i * _stride]);
+        }
+    }
+
+private:
+    const T *_begin;
+    size_t _size;
+    size_t _stride;
+};
+
+/// Strided counterpart of DataView, of either storage type.
+class StridedView
+{
+public:
+    StridedView() :
+        _singlePrecision(false)
+    {
+    }
+
+    StridedView(const double* begin, size_t size, size_t stride) :
+        _doubles(begin, size, stride), _singlePrecision(false)
+    {
+    }
+
+    StridedView(const float* begin, size_t size, size_t stride) :
+        _floats(begin, size, stride), _singlePrecision(true)
+    {
+    }
+
+    size_t size() const
+    {
+        return _singlePrecision ? _floats.size() : _doubles.size();
+    }
+
+    bool empty() const
+    {
+        return size() == 0;
+    }
+
+    /// Returns true if the values are stored in single precision.
+    bool isSinglePrecision() const
+    {
+        return _singlePrecision;
+    }
+
+    const BasicStridedView<double>& doubles() const
+    {
+        return _doubles;
+    }
+
+    const BasicStridedView<float>& floats() const
+    {
+        return _floats;
+    }
+
+    /// Returns the part of the view starting at idx.
+    StridedView subview(size_t idx, size_t size) const
+    {
+        StridedView view(*this);
+        if (_singlePrecision)
+        {
+            view._floats = _floats.subview(idx, size);
+        }
+        else
+        {
+            view._doubles = _doubles.subview(idx, size);
+        }
+        return view;
+    }
+
+    /// Copies the values to a contiguous vector.
+    std::vector<double> toVector() const
+    {
+        std::vector<double> values;
+        values.reserve(size());
+        if (_singlePrecision)
+        {
+            _floats.appendTo(values);
+        }
+        else
+        {
+            _doubles.appendTo(values);
+        }
+        return values;
+    }
+
+private:
+    BasicStridedView<double> _doubles;
+    BasicStridedView<float> _floats;
+    bool _singlePrecision;
+};
+
+}
+
+#endif /* DATAVIEW_H_ */
@@ -27,6 +27,7 @@
 
 #include <modelbase.h>
 
+#include <cstddef>
 #include <vector>
 
 namespace models
@@ -39,22 +40,54 @@ class Grey: public AbstractModel
 public:
     explicit Grey();
 
-    void provideInput(const std::vector<double>& inputValues, unsigned horizon);
+    void provideInput(const DataView& inputValues, unsigned horizon);
 
     double getPrediction(unsigned horizon);
 
-private:
-    const std::vector<double> performAGO(const std::vector<double>& input);
-    const std::vector<double> applyMean(const std::vector<double>& input);
-    void matrixOperations();
+    bool supportsSliding() const;
+    void slideInput(const DataView& newValues, unsigned horizon);
 
 private:
-    std::vector<double> _x0;
-    std::vector<double> _x1;
-    std::vector<double> _z1;
+    // the views are typed, the storage type is checked once per window
+    template<typename View>
+    void fit(const View& input);
+    template<typename View>
+    void slide(const View& newValues);
+    template<typename View>
+    void performAGO(const View& input, ArenaVector& output);
+    void applyMean(const ArenaVector& input, ArenaVector& output);
+    template<typename View>
+    void matrixOperations(const View& x0, const ArenaVector& z1);
+
+    double windowAt(size_t idx) const;
+    double cumulativeAt(size_t idx) const;
+
+    void resetSlidingSums();
+    void addTerm(double cumulative, double nextCumulative, double nextValue,
+            int sign);
+    void solveParameters(double C, double D, double E, double F, double n);
 
+private:
     double              _ag;
     double              _ug;
+
+    // sliding window state - the values of the window and the accumulated
+    // sums of the whole series seen since the last reset (the first element
+    // corresponds to the sample preceding the window); both are rings
+    // starting at their head, which keep their storage from fit to fit (the
+    // model outlives the arena of a single computation)
+    std::vector<double> _window;
+    size_t              _windowHead;
+    std::vector<double> _cumulative;
+    size_t              _cumulativeHead;
+    // sums of z(p), z(p)^2, x(p+1) and z(p)*x(p+1) over the window, where
+    // z(p) is the mean of the accumulated sums at p and p+1
+    double              _sumZ;
+    double              _sumZ2;
+    double              _sumX;
+    double              _sumZX;
+    // samples slid since the last reset of the sums
+    size_t              _slid;
 };
 
 }
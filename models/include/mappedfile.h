@@ -0,0 +1,80 @@
+/* * Copyright (c) 2010 Dariusz Gadomski <dgadomski@gmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation and/or
+ * other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef MAPPEDFILE_H_
+#define MAPPEDFILE_H_
+
+#include <string>
+
+#include <boost/noncopyable.hpp>
+
+namespace models
+{
+
+/// Read-only memory mapping of a whole file.
+class MappedFile: private boost::noncopyable
+{
+public:
+    MappedFile();
+    explicit MappedFile(const std::string& filename);
+    ~MappedFile();
+
+    bool open(const std::string& filename);
+    void close();
+
+    bool isOpen() const;
+
+    const char* data() const;
+    size_t size() const;
+
+    /// Asks the kernel to start reading the pages of [offset, offset +
+    /// length) in the background, so the first access does not wait.
+    void prefetch(size_t offset, size_t length) const;
+
+private:
+    void *_data;
+    size_t _size;
+};
+
+inline
+bool MappedFile::isOpen() const
+{
+    return _data != 0;
+}
+
+inline
+const char* MappedFile::data() const
+{
+    return static_cast<const char*> (_data);
+}
+
+inline
+size_t MappedFile::size() const
+{
+    return _size;
+}
+
+}
+
+#endif /* MAPPEDFILE_H_ */
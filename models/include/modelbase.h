@@ -25,6 +25,10 @@
 #ifndef MODELBASE_H_
 #define MODELBASE_H_
 
+#include <arena.h>
+#include <dataview.h>
+
+#include <cstddef>
 #include <vector>
 
 namespace models
@@ -33,8 +37,46 @@ namespace models
 class AbstractModel
 {
 public:
-    virtual void provideInput(const std::vector<double>& input, unsigned horizon) = 0;
+    AbstractModel() : _arena(0) {}
+    virtual ~AbstractModel() {}
+
+    /// Sets the arena for the temporaries of the computations (0 - heap).
+    /// The model frees nothing from it, the owner resets it between
+    /// requests.
+    void setArena(Arena* arena) { _arena = arena; }
+
+    /// Sets the window to predict from. The model must not keep the view,
+    /// it reads the values straight from the dataset memory.
+    virtual void provideInput(const DataView& input, unsigned horizon) = 0;
     virtual double getPrediction(unsigned horizon) = 0;
+
+    /// Returns true if the model implements slideInput().
+    virtual bool supportsSliding() const { return false; }
+
+    /// Moves the window given to the last provideInput() call forward by
+    /// newValues.size() samples: the oldest values are dropped and newValues
+    /// are appended. Costs O(newValues.size()) instead of O(window length).
+    virtual void slideInput(const DataView& newValues, unsigned horizon) {}
+
+    /// Returns true if predictBatch() is cheaper than a series of single
+    /// predictions.
+    virtual bool supportsBatch() const { return false; }
+
+    /// Computes a prediction for every input window, predictions[i] is the
+    /// prediction for inputs[i] with horizons[i].
+    virtual void predictBatch(const std::vector<DataView>& inputs,
+            const std::vector<unsigned>& horizons, std::vector<double>& predictions)
+    {
+        predictions.resize(inputs.size());
+        for (size_t i = 0; i < inputs.size(); ++i)
+        {
+            provideInput(inputs[i], horizons[i]);
+            predictions[i] = getPrediction(horizons[i]);
+        }
+    }
+
+protected:
+    Arena *_arena;
 };
 
 }
@@ -42,6 +42,10 @@ public:
     virtual LayerType getType() const { return Layer::Input; }
 
     virtual void insertInput(const std::vector<double>& input);
+
+private:
+    // input of a single neuron, kept to reuse its storage
+    std::vector<double> _neuronInput;
 };
 
 }
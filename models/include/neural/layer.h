@@ -81,7 +81,7 @@ public:
 
     virtual void insertInput(const std::vector<double>& input);
 
-    virtual std::vector<double> getOutput() const;
+    virtual const std::vector<double>& getOutput() const;
 
     virtual size_t neuronCount() const;
 
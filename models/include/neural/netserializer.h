@@ -29,6 +29,7 @@
 
 #include <neural/layer.h>
 
+#include <istream>
 #include <string>
 
 #include <boost/shared_ptr.hpp>
@@ -47,6 +48,7 @@ public:
 
     void saveToFile(const boost::shared_ptr<NeuralNet>& net, const std::string& filename);
     NeuralNet * loadFromFile(const std::string& filename);
+    NeuralNet * loadFromStream(std::istream& input);
 
 private:
     std::string getFieldValue(const std::string & line);
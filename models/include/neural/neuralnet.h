@@ -28,6 +28,7 @@
 #include <neural/layer.h>
 #include <modelbase.h>
 
+#include <istream>
 #include <map>
 #include <vector>
 
@@ -64,7 +65,7 @@ public:
 
     void setLayers(const std::vector<boost::shared_ptr<Layer> >& layers);
 
-    void provideInput(const std::vector<double>& inputValues, unsigned horizon);
+    void provideInput(const DataView& inputValues, unsigned horizon);
 
     void trainingStep(const std::vector<double>& inputValues,
             std::vector<double>& expectedOutput);
@@ -73,21 +74,49 @@ public:
 
     double getPrediction(unsigned horizon);
 
+    bool supportsBatch() const;
+    void predictBatch(const std::vector<DataView>& inputs,
+            const std::vector<unsigned>& horizons,
+            std::vector<double>& predictions);
+
     double getLearningFactor() const;
     void setLearningFactor(double learningFactor);
 
     void save(const std::string& filename);
     static NeuralNet * load(const std::string& filename);
+    static NeuralNet * load(std::istream& input);
 
     void setScale(double scale);
     double getScale() const;
 
 private:
+    /// Weights of a layer copied into a single neuron-major array, so that
+    /// a batch of inputs can be pushed through the net without going
+    /// through the Neuron objects.
+    struct DenseLayer
+    {
+        DenseLayer() :
+            Neurons(0), Width(0), Bias(0.0), SingleInput(false)
+        {
+        }
+
+        size_t Neurons;
+        size_t Width;
+        std::vector<double> Weights;
+        double Bias;
+        boost::shared_ptr<ActivationFunction> Function;
+        // every neuron of an input layer only sees its own input value
+        bool SingleInput;
+    };
+
+    void compileLayers();
+    void forwardBatch(ArenaVector& values, ArenaVector& output,
+            size_t batchSize, size_t width) const;
     void backPropagationTraining(Layer *outputLayer);
     void calculateErrorValues(Layer *outputLayer);
     void updateWeightValues();
     void updateLearningFactor();
-    std::vector<double> scaleVector(const std::vector<double>& vec) const;
+    void scaleVector(const DataView& vec, std::vector<double>& result) const;
 
 private:
     std::vector<boost::shared_ptr<Layer> > _layers;
@@ -103,6 +132,9 @@ private:
     std::vector<double> _resultBuffer;
     std::vector<double> _inputBuffer;
     double _scale;
+
+    // filled on the first predictBatch() call, cleared by training
+    std::vector<DenseLayer> _dense;
 };
 
 inline
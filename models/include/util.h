@@ -57,23 +57,23 @@ inline DebugLevel getVerbosity()
 
 std::ostream& dbg(debug::DebugLevel level = debug::Debug);
 
-template<typename T>
-void printSeq(const std::string& comment, const std::vector<T>& seq,
+template<typename Seq>
+void printSeq(const std::string& comment, const Seq& seq,
         DebugLevel debugLevel = Debug, const std::string& separator = std::string(", "))
 {
     dbg(debugLevel) << comment;
-    std::copy(seq.begin(), seq.end(), std::ostream_iterator<T>(dbg(debugLevel),
-            separator.c_str()));
+    std::copy(seq.begin(), seq.end(), std::ostream_iterator<
+            typename Seq::value_type>(dbg(debugLevel), separator.c_str()));
     dbg(debugLevel) << std::endl;
 }
 
-template<typename T>
-void printSeq(std::ostream& out, const std::string& comment, const std::vector<T>& seq,
+template<typename Seq>
+void printSeq(std::ostream& out, const std::string& comment, const Seq& seq,
         DebugLevel debugLevel = Debug, const std::string& separator = std::string(", "))
 {
     out << comment;
-    std::copy(seq.begin(), seq.end(), std::ostream_iterator<T>(out,
-            separator.c_str()));
+    std::copy(seq.begin(), seq.end(), std::ostream_iterator<
+            typename Seq::value_type>(out, separator.c_str()));
     out << std::endl;
 }
 
@@ -0,0 +1,97 @@
+//
+// Copyright (c) 2010 Dariusz Gadomski <dgadomski@gmail.com>
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <arena.h>
+
+#include <algorithm>
+
+namespace models
+{
+
+namespace
+{
+// alignment of every allocation, enough for any scalar type
+const size_t ALIGNMENT = 16;
+}
+
+const size_t Arena::DEFAULT_BLOCK_SIZE;
+
+Arena::Arena(size_t blockSize) :
+    _blockSize(std::max(blockSize, ALIGNMENT)), _current(0), _offset(0),
+            _used(0)
+{
+}
+
+Arena::~Arena()
+{
+    for (size_t i = 0; i < _blocks.size(); ++i)
+    {
+        ::operator delete(_blocks[i].Data);
+    }
+}
+
+void* Arena::allocate(size_t size)
+{
+    size = (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+
+    while (_current < _blocks.size() && _offset + size
+            > _blocks[_current].Size)
+    {
+        ++_current;
+        _offset = 0;
+    }
+
+    if (_current == _blocks.size())
+    {
+        Block block;
+        block.Size = std::max(_blockSize, size);
+        block.Data = static_cast<char*> (::operator new(block.Size));
+        _blocks.push_back(block);
+    }
+
+    void *ptr = _blocks[_current].Data + _offset;
+    _offset += size;
+    _used += size;
+    return ptr;
+}
+
+void Arena::reset()
+{
+    _current = 0;
+    _offset = 0;
+    _used = 0;
+}
+
+size_t Arena::getCapacity() const
+{
+    size_t capacity = 0;
+    for (size_t i = 0; i < _blocks.size(); ++i)
+    {
+        capacity += _blocks[i].Size;
+    }
+    return capacity;
+}
+
+}
@@ -63,11 +63,20 @@ Arima::Arima() :
 {
     dbg(debug::Informational) << "Arima()" << std::endl;
     fillOrder();
-    if (!mkfifo(Arima::FILE_TEMPLATE, 0666))
+
+    // every instance gets its own pipe, so that several models can run R
+    // at the same time
+    strcpy(_tempFilename, FILE_TEMPLATE);
+    int fd = mkstemp(_tempFilename);
+    if (fd >= 0)
+    {
+        close(fd);
+        unlink(_tempFilename);
+    }
+    if (mkfifo(_tempFilename, 0666) != 0)
     {
         dbg(debug::High) << "Error creating named pipe" << std::endl;
     }
-    strcpy(_tempFilename, FILE_TEMPLATE);
     dbg(debug::Informational) << "Arima() - END" << std::endl;
 }
 
@@ -129,11 +138,12 @@ void Arima::preparePrediction(char * filename, unsigned horizon)
     dbg(debug::Informational) << "preparePrediction - END" << std::endl;
 }
 
-void Arima::provideInput(const std::vector<double>& input, unsigned horizon)
+void Arima::provideInput(const DataView& input, unsigned horizon)
 {
     dbg(debug::Informational) << "provideInput: " << "(, horizon: " << horizon
             << ")" << std::endl;
-    _input = input;
+    // kept for the R script written by the prediction
+    input.copyTo(_input);
     _outputBuff.clear();
     _outputBuff.reserve(horizon);
     _horizon = horizon;
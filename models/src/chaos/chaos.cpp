@@ -67,10 +67,10 @@ double Chaos::getPrediction(unsigned horizon)
     return _outputBuffer[horizon-1];
 }
 
-void Chaos::provideInput(const std::vector<double> & inputValues,
-        unsigned horizon)
+void Chaos::provideInput(const DataView& inputValues, unsigned horizon)
 {
-    _inputBuffer = inputValues;
+    // the predictions are appended to the input
+    inputValues.copyTo(_inputBuffer);
     _outputBuffer.clear();
     _outputBuffer.reserve(horizon);
 
@@ -33,7 +33,9 @@ namespace comm
 namespace protocol
 {
 Message::Message():
-        DataOffset(0), DataLength(0), Horizon(0), Result(0.0)
+        DataOffset(0), DataLength(0), Horizon(0), Result(0.0),
+        Priority(Normal), Deadline(0), Latest(false), Resolution(1),
+        Aggregation(0)
 {
 }
 
@@ -46,9 +48,37 @@ ostream &operator<<(ostream &out, const comm::protocol::Message& msg)
 {
     static const std::string bar("=================================================");
     out << bar << endl;
-    out << "Data: (" << msg.DataOffset << ", " << msg.DataLength << ")" << endl;
+    out << "Data: (" << msg.DataOffset << ", " << msg.DataLength << ")";
+    if (!msg.DatasetId.empty())
+    {
+        out << " of " << msg.DatasetId;
+    }
+    if (!msg.SeriesId.empty())
+    {
+        out << " of series " << msg.SeriesId;
+    }
+    if (msg.Resolution > 1)
+    {
+        out << " at resolution " << msg.Resolution << " (aggregation "
+                << msg.Aggregation << ")";
+    }
+    if (msg.Latest)
+    {
+        out << " (latest)";
+    }
+    out << endl;
     out << "Prediction: " << msg.Result << " (horizon: " << msg.Horizon << ")"
             << endl;
+    if (!msg.Error.empty())
+    {
+        out << "Error: " << msg.Error << endl;
+    }
+    for (size_t i = 0; i < msg.Components.size(); ++i)
+    {
+        out << "  " << (i < msg.ComponentAlgorithms.size()
+                ? msg.ComponentAlgorithms[i] : std::string("?")) << ": "
+                << msg.Components[i] << endl;
+    }
     out << bar << endl;
     return out;
 }
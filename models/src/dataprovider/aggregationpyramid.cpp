@@ -0,0 +1,191 @@
+//
+// Copyright (c) 2010 Dariusz Gadomski <dgadomski@gmail.com>
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <dataprovider/aggregationpyramid.h>
+
+#include <util.h>
+
+#include <algorithm>
+#include <sstream>
+
+namespace models
+{
+
+namespace dataprovider
+{
+
+using namespace debug;
+
+namespace
+{
+
+const char* AGGREGATION_NAMES[AggregationPyramid::NumAggregations] =
+{ "mean", "sum", "max" };
+
+/// Combines groups of group values of the finer level into the sums, maxima
+/// and means of the coarser one.
+template<typename View>
+void aggregate(const View& sourceSums, const View& sourceMaxima,
+        unsigned group, unsigned factor, std::vector<double>& sums,
+        std::vector<double>& maxima, std::vector<double>& means)
+{
+    size_t count = sourceSums.size() / group;
+    sums.resize(count);
+    maxima.resize(count);
+    means.resize(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        size_t begin = i * group;
+        double sum = 0.0;
+        double max = sourceMaxima[begin];
+        for (size_t j = begin; j < begin + group; ++j)
+        {
+            sum += sourceSums[j];
+            max = std::max<double>(max, sourceMaxima[j]);
+        }
+        sums[i] = sum;
+        maxima[i] = max;
+        means[i] = sum / factor;
+    }
+}
+
+}
+
+AggregationPyramid::AggregationPyramid(const DataProvider& data,
+        const std::vector<unsigned>& factors)
+{
+    for (size_t i = 0; i < factors.size(); ++i)
+    {
+        if (factors[i] > 1)
+        {
+            _factors.push_back(factors[i]);
+        }
+    }
+    std::sort(_factors.begin(), _factors.end());
+    _factors.erase(std::unique(_factors.begin(), _factors.end()),
+            _factors.end());
+
+    // sums and maxima of the finest level computed so far for every factor,
+    // the means are the sums divided by the factor
+    std::vector<std::vector<double> > sums(_factors.size());
+    std::vector<std::vector<double> > maxima(_factors.size());
+
+    // a mapped series is read in place
+    DataView series(data.getView(data.getFirstIndex(), data.getDataSize()
+            - data.getFirstIndex()));
+    for (size_t k = 0; k < _factors.size(); ++k)
+    {
+        unsigned factor = _factors[k];
+
+        // the finest level whose groups tile the groups of this one
+        size_t source = k;
+        for (size_t j = k; j-- > 0;)
+        {
+            if (factor % _factors[j] == 0)
+            {
+                source = j;
+                break;
+            }
+        }
+
+        std::vector<double> means;
+        if (source < k)
+        {
+            aggregate(DoubleView(sums[source]), DoubleView(maxima[source]),
+                    factor / _factors[source], factor, sums[k], maxima[k],
+                    means);
+        }
+        else if (series.isSinglePrecision())
+        {
+            aggregate(series.floats(), series.floats(), factor, factor,
+                    sums[k], maxima[k], means);
+        }
+        else
+        {
+            aggregate(series.doubles(), series.doubles(), factor, factor,
+                    sums[k], maxima[k], means);
+        }
+        size_t count = means.size();
+
+        std::ostringstream name;
+        name << data.getFilename() << "@" << factor;
+        _levels.push_back(level_ptr(new DataProvider(name.str() + ":mean",
+                means)));
+        _levels.push_back(level_ptr(new DataProvider(name.str() + ":sum",
+                sums[k])));
+        _levels.push_back(level_ptr(new DataProvider(name.str() + ":max",
+                maxima[k])));
+
+        dbg(debug::Informational) << "Aggregated " << data.getFilename()
+                << " by " << factor << " into " << count << " values"
+                << std::endl;
+    }
+}
+
+AggregationPyramid::level_ptr AggregationPyramid::getLevel(unsigned factor,
+        unsigned aggregation) const
+{
+    std::vector<unsigned>::const_iterator it = std::lower_bound(
+            _factors.begin(), _factors.end(), factor);
+    if (it == _factors.end() || *it != factor || aggregation
+            >= NumAggregations)
+    {
+        return level_ptr();
+    }
+    return _levels[(it - _factors.begin()) * NumAggregations + aggregation];
+}
+
+size_t AggregationPyramid::getMemoryUsage() const
+{
+    size_t usage = 0;
+    for (size_t i = 0; i < _levels.size(); ++i)
+    {
+        usage += _levels[i]->getMemoryUsage();
+    }
+    return usage;
+}
+
+bool AggregationPyramid::parseAggregation(const std::string& name,
+        Aggregation& aggregation)
+{
+    for (unsigned i = 0; i < NumAggregations; ++i)
+    {
+        if (name == AGGREGATION_NAMES[i])
+        {
+            aggregation = static_cast<Aggregation> (i);
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* AggregationPyramid::getAggregationName(unsigned aggregation)
+{
+    return aggregation < NumAggregations ? AGGREGATION_NAMES[aggregation]
+            : "?";
+}
+
+}
+}
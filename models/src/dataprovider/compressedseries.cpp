@@ -0,0 +1,412 @@
+//
+// Copyright (c) 2010 Dariusz Gadomski <dgadomski@gmail.com>
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <dataprovider/compressedseries.h>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+namespace models
+{
+
+namespace dataprovider
+{
+
+namespace
+{
+
+typedef boost::uint64_t Word;
+
+// the leading zeros are stored in 5 bits, the length of the meaningful bits
+// in 6 (64 is stored as 0)
+const unsigned LEADING_BITS = 5;
+const unsigned MAX_LEADING = (1u << LEADING_BITS) - 1;
+const unsigned LENGTH_BITS = 6;
+
+inline Word toBits(double value)
+{
+    Word bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+inline double fromBits(Word bits)
+{
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+inline unsigned countLeadingZeros(Word bits)
+{
+    return __builtin_clzll(bits);
+}
+
+inline unsigned countTrailingZeros(Word bits)
+{
+    return __builtin_ctzll(bits);
+}
+
+/// Appends bits to a vector of words, the first bit is the highest one.
+class BitWriter
+{
+public:
+    BitWriter(std::vector<Word>& words) :
+        _words(words), _position(0)
+    {
+    }
+
+    /// Appends the lowest count bits of value, count is at most 64.
+    void write(Word value, unsigned count)
+    {
+        if (count == 0)
+        {
+            return;
+        }
+        if (count < 64)
+        {
+            value &= (Word(1) << count) - 1;
+        }
+
+        unsigned used = _position % 64;
+        if (used == 0)
+        {
+            _words.push_back(0);
+        }
+        unsigned free = 64 - used;
+        if (count <= free)
+        {
+            _words.back() |= value << (free - count);
+        }
+        else
+        {
+            _words.back() |= value >> (count - free);
+            _words.push_back(value << (64 - (count - free)));
+        }
+        _position += count;
+    }
+
+    Word getPosition() const
+    {
+        return _position;
+    }
+
+private:
+    std::vector<Word>& _words;
+    Word _position;
+};
+
+/// Reads the bits written by the BitWriter.
+class BitReader
+{
+public:
+    BitReader(const Word* words, Word position) :
+        _words(words), _position(position)
+    {
+    }
+
+    /// Reads count bits, count is between 1 and 64.
+    Word read(unsigned count)
+    {
+        const Word *word = _words + _position / 64;
+        unsigned used = _position % 64;
+        unsigned available = 64 - used;
+        _position += count;
+
+        if (count <= available)
+        {
+            return (word[0] << used) >> (64 - count);
+        }
+        unsigned rest = count - available;
+        Word high = word[0] & ((Word(1) << available) - 1);
+        return (high << rest) | (word[1] >> (64 - rest));
+    }
+
+    bool readBit()
+    {
+        bool bit = (_words[_position / 64] >> (63 - _position % 64)) & 1;
+        ++_position;
+        return bit;
+    }
+
+private:
+    const Word *_words;
+    Word _position;
+};
+
+}
+
+const size_t CompressedSeries::BLOCK_SIZE;
+
+CompressedSeries::Summary::Summary() :
+    Count(0), Mean(0.0), Deviation(0.0), Min(0.0), Max(0.0)
+{
+}
+
+CompressedSeries::Summary::Summary(const double* values, size_t size) :
+    Count(size), Mean(0.0), Deviation(0.0), Min(0.0), Max(0.0)
+{
+    if (size == 0)
+    {
+        return;
+    }
+
+    double sum = 0.0;
+    for (size_t i = 0; i < size; ++i)
+    {
+        sum += values[i];
+    }
+    Mean = sum / size;
+
+    Min = Max = values[0];
+    for (size_t i = 0; i < size; ++i)
+    {
+        Deviation += (values[i] - Mean) * (values[i] - Mean);
+        Min = std::min(Min, values[i]);
+        Max = std::max(Max, values[i]);
+    }
+}
+
+void CompressedSeries::Summary::merge(const Summary& other)
+{
+    if (other.Count == 0)
+    {
+        return;
+    }
+    if (Count == 0)
+    {
+        *this = other;
+        return;
+    }
+
+    double count = Count + other.Count;
+    double delta = other.Mean - Mean;
+    Mean += delta * other.Count / count;
+    Deviation += other.Deviation + delta * delta * Count * other.Count
+            / count;
+    Min = std::min(Min, other.Min);
+    Max = std::max(Max, other.Max);
+    Count += other.Count;
+}
+
+CompressedSeries::CompressedSeries(const DoubleView& values) :
+    _count(values.size())
+{
+    BitWriter writer(_bits);
+
+    Word previous = 0;
+    unsigned leading = 0;
+    unsigned trailing = 0;
+    for (size_t i = 0; i < values.size(); ++i)
+    {
+        Word current = toBits(values[i]);
+        if (i % BLOCK_SIZE == 0)
+        {
+            // the blocks are decoded on their own
+            _blocks.push_back(writer.getPosition());
+            writer.write(current, 64);
+            previous = current;
+            leading = 64;
+            trailing = 0;
+            continue;
+        }
+
+        Word diff = current ^ previous;
+        previous = current;
+        if (diff == 0)
+        {
+            writer.write(0, 1);
+            continue;
+        }
+
+        unsigned newLeading = std::min(countLeadingZeros(diff), MAX_LEADING);
+        unsigned newTrailing = countTrailingZeros(diff);
+        if (leading != 64 && newLeading >= leading && newTrailing >= trailing)
+        {
+            // the bits fit into the bounds of the previous value
+            writer.write(2, 2);
+            writer.write(diff >> trailing, 64 - leading - trailing);
+            continue;
+        }
+
+        leading = newLeading;
+        trailing = newTrailing;
+        unsigned length = 64 - leading - trailing;
+        writer.write(3, 2);
+        writer.write(leading, LEADING_BITS);
+        writer.write(length, LENGTH_BITS);
+        writer.write(diff >> trailing, length);
+    }
+
+    std::vector<Word>(_bits).swap(_bits);
+
+    summarizeBlocks(values.begin());
+}
+
+CompressedSeries::CompressedSeries(std::vector<Word>& bits,
+        std::vector<Word>& blocks, size_t count) :
+    _count(0)
+{
+    // every block starts with a raw value inside the bits
+    if (blocks.size() != (count + BLOCK_SIZE - 1) / BLOCK_SIZE)
+    {
+        return;
+    }
+    for (size_t i = 0; i < blocks.size(); ++i)
+    {
+        if (blocks[i] + 64 > bits.size() * 64)
+        {
+            return;
+        }
+    }
+
+    _bits.swap(bits);
+    _blocks.swap(blocks);
+    _count = count;
+    summarizeBlocks(0);
+}
+
+double CompressedSeries::getValue(size_t idx) const
+{
+    double value;
+    decode(idx, 1, &value);
+    return value;
+}
+
+void CompressedSeries::decode(size_t idx, size_t size, double* output) const
+{
+    size_t end = idx + size;
+    size_t i = idx - idx % BLOCK_SIZE;
+
+    Word value = 0;
+    unsigned leading = 0;
+    unsigned trailing = 0;
+    BitReader reader(_bits.empty() ? 0 : &_bits[0], 0);
+    for (; i < end; ++i)
+    {
+        if (i % BLOCK_SIZE == 0)
+        {
+            reader = BitReader(&_bits[0], _blocks[i / BLOCK_SIZE]);
+            value = reader.read(64);
+        }
+        else if (reader.readBit())
+        {
+            if (reader.readBit())
+            {
+                leading = reader.read(LEADING_BITS);
+                unsigned length = reader.read(LENGTH_BITS);
+                trailing = 64 - leading - (length ? length : 64);
+            }
+            value ^= reader.read(64 - leading - trailing) << trailing;
+        }
+
+        if (i >= idx)
+        {
+            output[i - idx] = fromBits(value);
+        }
+    }
+}
+
+double CompressedSeries::getMean(size_t idx, size_t size) const
+{
+    return size ? summarize(idx, size).Mean
+            : std::numeric_limits<double>::quiet_NaN();
+}
+
+double CompressedSeries::getVariance(size_t idx, size_t size) const
+{
+    return size ? summarize(idx, size).Deviation / size
+            : std::numeric_limits<double>::quiet_NaN();
+}
+
+double CompressedSeries::getMin(size_t idx, size_t size) const
+{
+    return size ? summarize(idx, size).Min
+            : std::numeric_limits<double>::quiet_NaN();
+}
+
+double CompressedSeries::getMax(size_t idx, size_t size) const
+{
+    return size ? summarize(idx, size).Max
+            : std::numeric_limits<double>::quiet_NaN();
+}
+
+void CompressedSeries::summarizeBlocks(const double* values)
+{
+    // the blocks are decoded if the values are not given
+    double block[BLOCK_SIZE];
+    _summaries.reserve(_blocks.size());
+    for (size_t begin = 0; begin < _count; begin += BLOCK_SIZE)
+    {
+        size_t count = std::min(BLOCK_SIZE, _count - begin);
+        if (!values)
+        {
+            decode(begin, count, block);
+        }
+        _summaries.push_back(Summary(values ? values + begin : block, count));
+    }
+}
+
+CompressedSeries::Summary CompressedSeries::summarize(size_t idx,
+        size_t size) const
+{
+    Summary summary;
+    size_t end = idx + size;
+    while (idx < end)
+    {
+        size_t block = idx / BLOCK_SIZE;
+        size_t blockEnd = std::min((block + 1) * BLOCK_SIZE, _count);
+        if (idx % BLOCK_SIZE == 0 && blockEnd <= end)
+        {
+            summary.merge(_summaries[block]);
+            idx = blockEnd;
+            continue;
+        }
+
+        // a partial block at an end of the range
+        double values[BLOCK_SIZE];
+        size_t count = std::min(blockEnd, end) - idx;
+        decode(idx, count, values);
+        summary.merge(Summary(values, count));
+        idx += count;
+    }
+    return summary;
+}
+
+size_t CompressedSeries::getMemoryUsage() const
+{
+    return (_bits.size() + _blocks.size()) * sizeof(Word) + _summaries.size()
+            * sizeof(Summary);
+}
+
+double CompressedSeries::getCompressionRatio() const
+{
+    size_t usage = getMemoryUsage();
+    return usage ? double(_count * sizeof(double)) / usage : 1.0;
+}
+
+}
+}
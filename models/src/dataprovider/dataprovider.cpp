@@ -24,15 +24,19 @@
 //
 
 #include <dataprovider/dataprovider.h>
+#include <dataprovider/compressedseries.h>
+#include <dataprovider/rangeindex.h>
+#include <dataprovider/seriesfile.h>
+#include <dataprovider/textparser.h>
 
 #include <util.h>
 
 #include <algorithm>
 #include <cmath>
-#include <fstream>
 #include <iostream>
-#include <list>
-#include <sstream>
+#include <limits>
+
+#include <boost/thread/tss.hpp>
 
 using namespace std;
 namespace models
@@ -43,50 +47,366 @@ namespace dataprovider
 
 using namespace debug;
 
-DataProvider::DataProvider(const std::string& filename) :
-    _filename(filename)
+namespace
+{
+
+/// Buffer of every thread the compressed windows are decoded into.
+boost::thread_specific_ptr<boost::shared_ptr<std::vector<double> > >
+        decodeBuffers;
+
+/// Range statistics of the values which are not indexed, NaN for an empty
+/// range like the ones of the RangeIndex.
+template<typename T>
+double scanMean(const T* values, size_t size)
+{
+    if (size == 0)
+    {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    double sum = 0.0;
+    for (size_t i = 0; i < size; ++i)
+    {
+        sum += values[i];
+    }
+    return sum / size;
+}
+
+template<typename T>
+double scanVariance(const T* values, size_t size)
+{
+    double mean = scanMean(values, size);
+    double sum = 0.0;
+    for (size_t i = 0; i < size; ++i)
+    {
+        sum += (values[i] - mean) * (values[i] - mean);
+    }
+    return sum / size;
+}
+
+template<typename T>
+double scanMin(const T* values, size_t size)
+{
+    if (size == 0)
+    {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    return *std::min_element(values, values + size);
+}
+
+template<typename T>
+double scanMax(const T* values, size_t size)
+{
+    if (size == 0)
+    {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    return *std::max_element(values, values + size);
+}
+
+}
+
+DataProvider::DataProvider(const std::string& filename, Precision precision) :
+    _filename(filename), _data(0), _floats(0), _size(0), _first(0),
+            _maxValue(0.0)
 {
-    loadFromFile(_filename);
+    if (SeriesFile::isSeriesFile(_filename))
+    {
+        mapSeriesFile(_filename);
+    }
+    else
+    {
+        loadFromFile(_filename);
+        storeItems(precision);
+    }
     dbg() << "DataProvider(): " << _filename << std::endl;
 }
 
+DataProvider::DataProvider(const std::string& filename,
+        const std::vector<double>& items, Precision precision) :
+    _filename(filename), _items(items), _data(0), _floats(0), _size(0),
+            _first(0), _maxValue(0.0)
+{
+    storeItems(precision);
+    dbg() << "DataProvider(): " << _filename << " (" << _size << " items)"
+            << std::endl;
+}
+
+DataProvider::DataProvider(const std::string& filename,
+        std::vector<double>& items, size_t first, double maxValue) :
+    _filename(filename), _data(0), _floats(0), _size(0), _first(first),
+            _maxValue(maxValue)
+{
+    _items.swap(items);
+    updateView();
+}
+
+DataProvider::DataProvider(const std::string& filename,
+        const DataView& values, const boost::shared_ptr<const void>& storage) :
+    _filename(filename), _storage(storage), _data(0), _floats(0),
+            _size(values.size()), _first(0), _maxValue(0.0)
+{
+    if (values.isSinglePrecision())
+    {
+        _floats = values.floats().begin();
+    }
+    else
+    {
+        _data = values.doubles().begin();
+    }
+    _maxValue = _size ? getMaxValue(0, _size) : 0.0;
+}
+
+DataProvider::DataProvider(const std::string& filename,
+        const boost::shared_ptr<const CompressedSeries>& values) :
+    _filename(filename), _compressed(values), _data(0), _floats(0),
+            _size(0), _first(0), _maxValue(0.0)
+{
+    updateView();
+    _maxValue = _size ? getMaxValue(0, _size) : 0.0;
+}
+
+DataProvider::DataProvider(const DataProvider& other) :
+    _filename(other._filename), _items(other._items),
+            _floatItems(other._floatItems), _series(other._series),
+            _compressed(other._compressed), _storage(other._storage),
+            _data(other._data), _floats(other._floats), _size(other._size),
+            _first(other._first), _index(other._index),
+            _maxValue(other._maxValue)
+{
+    updateView();
+}
+
 DataProvider::~DataProvider()
 {
     dbg() << "~DataProvider()" << std::endl;
 }
 
-double DataProvider::getData(int idx) const
+DataProvider& DataProvider::operator=(const DataProvider& other)
 {
-    return _items[idx];
+    if (this != &other)
+    {
+        _filename = other._filename;
+        _items = other._items;
+        _floatItems = other._floatItems;
+        _series = other._series;
+        _compressed = other._compressed;
+        _storage = other._storage;
+        _data = other._data;
+        _floats = other._floats;
+        _size = other._size;
+        _first = other._first;
+        _index = other._index;
+        _maxValue = other._maxValue;
+        updateView();
+    }
+    return *this;
 }
 
-std::vector<double> DataProvider::getDataVector(int idx, size_t size) const
+void DataProvider::storeItems(Precision precision)
 {
-    std::vector<double> tmpVector;
+    // the parsed values are converted to the precision they are kept in
+    if (precision == SinglePrecision)
+    {
+        _floatItems.assign(_items.begin(), _items.end());
+        std::vector<double>().swap(_items);
+    }
+    else if (precision == Compressed)
+    {
+        _compressed.reset(new CompressedSeries(_items));
+        std::vector<double>().swap(_items);
+    }
+    updateView();
+    if (precision == DoublePrecision)
+    {
+        buildIndex();
+    }
+    _maxValue = _size ? getMaxValue(0, _size) : 0.0;
+}
 
-    for (size_t i = 0; i < size; ++i)
+void DataProvider::updateView()
+{
+    if (_series)
     {
-        tmpVector.push_back(_items[idx + i]);
+        _data = _series->getValues();
+        _floats = _series->getFloatValues();
+        _size = _series->getCount();
     }
+    else if (_compressed)
+    {
+        _data = 0;
+        _floats = 0;
+        _size = _compressed->getCount();
+    }
+    else if (_storage)
+    {
+        // the values were set on construction and copied
+    }
+    else if (!_floatItems.empty())
+    {
+        _data = 0;
+        _floats = &_floatItems[0];
+        _size = _floatItems.size();
+    }
+    else
+    {
+        _data = _items.empty() ? 0 : &_items[0];
+        _floats = 0;
+        _size = _items.size();
+    }
+}
 
-    return tmpVector;
+std::vector<double> DataProvider::getItems() const
+{
+    std::vector<double> values;
+    getView(_first, _size).copyTo(values);
+    return values;
 }
 
-size_t DataProvider::getDataSize() const
+std::vector<double> DataProvider::getDataVector(int idx, size_t size) const
 {
-    return _items.size();
+    std::vector<double> values;
+    getView(idx, size).copyTo(values);
+    return values;
 }
 
 double DataProvider::getAverage(int idx, size_t size) const
 {
-    double sum = 0.0;
+    if (_index)
+    {
+        return _index->getMean(idx - _first, size);
+    }
 
-    for (size_t i = idx; i < idx + size; ++i)
+    if (_compressed)
     {
-        sum += _items[i];
+        return _compressed->getMean(idx - _first, size);
     }
 
-    return sum / size;
+    size_t begin = idx - _first;
+    return _floats ? scanMean(_floats + begin, size) : scanMean(_data + begin,
+            size);
+}
+
+double DataProvider::getVariance(int idx, size_t size) const
+{
+    if (_index)
+    {
+        return _index->getVariance(idx - _first, size);
+    }
+
+    if (_compressed)
+    {
+        return _compressed->getVariance(idx - _first, size);
+    }
+
+    size_t begin = idx - _first;
+    return _floats ? scanVariance(_floats + begin, size) : scanVariance(_data
+            + begin, size);
+}
+
+double DataProvider::getMinValue(int idx, size_t size) const
+{
+    if (_index)
+    {
+        return _index->getMin(_data, idx - _first, size);
+    }
+
+    if (_compressed)
+    {
+        return _compressed->getMin(idx - _first, size);
+    }
+
+    size_t begin = idx - _first;
+    return _floats ? scanMin(_floats + begin, size) : scanMin(_data + begin,
+            size);
+}
+
+double DataProvider::getMaxValue(int idx, size_t size) const
+{
+    if (_index)
+    {
+        return _index->getMax(_data, idx - _first, size);
+    }
+
+    if (_compressed)
+    {
+        return _compressed->getMax(idx - _first, size);
+    }
+
+    size_t begin = idx - _first;
+    return _floats ? scanMax(_floats + begin, size) : scanMax(_data + begin,
+            size);
+}
+
+size_t DataProvider::getMemoryUsage() const
+{
+    // mapped values live in the page cache, which the kernel evicts by
+    // itself
+    if (_series)
+    {
+        return 0;
+    }
+    if (_compressed)
+    {
+        return _compressed->getMemoryUsage();
+    }
+    return _size * (_floats ? sizeof(float) : sizeof(double)) + (_index
+            ? _index->getMemoryUsage() : 0);
+}
+
+double DataProvider::getCompressionRatio() const
+{
+    return _compressed ? _compressed->getCompressionRatio() : 1.0;
+}
+
+void DataProvider::prefetch(int idx, size_t size) const
+{
+    if (!_series || static_cast<size_t> (idx) >= _first + _size)
+    {
+        return;
+    }
+
+    size = std::min(size, _first + _size - idx);
+    _series->prefetch(idx - _first, size);
+}
+
+void DataProvider::rebuildIndex()
+{
+    if (_index)
+    {
+        buildIndex();
+    }
+}
+
+void DataProvider::buildIndex()
+{
+    _index.reset(new RangeIndex(_data, _size));
+}
+
+double DataProvider::decodeValue(int idx) const
+{
+    return _compressed->getValue(idx - _first);
+}
+
+DataView DataProvider::decodeView(int idx, size_t size) const
+{
+    // the buffer of the thread is reused, unless a view of the window
+    // decoded last is still held
+    if (!decodeBuffers.get())
+    {
+        decodeBuffers.reset(new boost::shared_ptr<std::vector<double> >());
+    }
+    boost::shared_ptr<std::vector<double> >& buffer = *decodeBuffers;
+    if (!buffer || !buffer.unique())
+    {
+        buffer.reset(new std::vector<double>());
+    }
+
+    buffer->resize(size);
+    if (size)
+    {
+        _compressed->decode(idx - _first, size, &(*buffer)[0]);
+    }
+    return DataView(boost::shared_ptr<const std::vector<double> >(buffer));
 }
 
 double DataProvider::getMeanSquareError(const std::vector<double> & expected,
@@ -106,8 +426,7 @@ double DataProvider::getMeanSquareError(const std::vector<double> & expected,
 
 double DataProvider::getMaxValue() const
 {
-    double max = *std::max_element(_items.begin(), _items.end());
-    return max;
+    return _maxValue;
 }
 
 double DataProvider::getVariance(const std::vector<double> & expected,
@@ -174,37 +493,27 @@ double DataProvider::getSignalToErrorRatio(
     return 10 * std::log10(rmsData / rmsError);
 }
 
-bool DataProvider::loadFromFile(const std::string & filename)
+bool DataProvider::mapSeriesFile(const std::string& filename)
 {
-    ifstream inData;
-    list<double> tmpList;
-    inData.open(filename.c_str());
-    if (!inData)
-        return false;
-
-    size_t size = 0;
-    string line;
-    while (!inData.eof())
+    boost::shared_ptr<SeriesFile> series(new SeriesFile(filename));
+    if (!series->isValid())
     {
-        getline(inData, line);
-        double tmp = 0.0;
-        std::istringstream iss(line);
-        if (iss >> tmp)
-        {
-            tmpList.push_back(tmp);
-        }
-        else
-        {
-        }
-
-        size++;
+        return false;
     }
 
-    _items.reserve(size);
-    copy(tmpList.begin(), tmpList.end(), back_inserter(_items));
-
+    _series = series;
+    updateView();
+    // the series may be larger than the memory, so it is not indexed (the
+    // index takes more than twice the memory of the values); the
+    // statistics are computed by the converter
+    _maxValue = _series->getHeader().Max;
     return true;
 }
 
+bool DataProvider::loadFromFile(const std::string & filename)
+{
+    return TextParser().parseValues(filename, _items);
+}
+
 }
 }
@@ -0,0 +1,74 @@
+//
+// Copyright (c) 2010 Dariusz Gadomski <dgadomski@gmail.com>
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <dataprovider/erroraccumulator.h>
+
+#include <cmath>
+
+namespace models
+{
+
+namespace dataprovider
+{
+
+ErrorMetrics::ErrorMetrics() :
+    MeanSquareError(0.0), NormalizedMeanSquareError(0.0),
+            SignalToErrorRatio(0.0)
+{
+}
+
+ErrorAccumulator::ErrorAccumulator() :
+    _count(0), _mean(0.0), _deviation(0.0), _meanSquare(0.0),
+            _meanSquareError(0.0)
+{
+}
+
+void ErrorAccumulator::add(double expected, double actual)
+{
+    ++_count;
+
+    double delta = actual - _mean;
+    _mean += delta / _count;
+    _deviation += delta * (actual - _mean);
+
+    double error = expected - actual;
+    _meanSquareError += (error * error - _meanSquareError) / _count;
+    _meanSquare += (actual * actual - _meanSquare) / _count;
+}
+
+ErrorMetrics ErrorAccumulator::getMetrics() const
+{
+    ErrorMetrics metrics;
+    metrics.MeanSquareError = _meanSquareError;
+    metrics.NormalizedMeanSquareError = _meanSquareError / (_deviation
+            / _count);
+    metrics.SignalToErrorRatio = 10 * std::log10(std::sqrt(_meanSquare)
+            / std::sqrt(_meanSquareError));
+    return metrics;
+}
+
+}
+
+}
@@ -0,0 +1,226 @@
+//
+// Copyright (c) 2010 Dariusz Gadomski <dgadomski@gmail.com>
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <dataprovider/gziplinereader.h>
+
+#include <util.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include <boost/bind.hpp>
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+namespace models
+{
+
+namespace dataprovider
+{
+
+using namespace debug;
+
+const size_t GzipLineReader::BLOCK_SIZE;
+const size_t GzipLineReader::MAX_QUEUED_BLOCKS;
+
+GzipLineReader::GzipLineReader(const char* data, size_t size) :
+    _data(data), _size(size), _done(false), _failed(false), _stopping(false)
+{
+    _thread = boost::thread(boost::bind(&GzipLineReader::inflate, this));
+}
+
+GzipLineReader::~GzipLineReader()
+{
+    {
+        boost::lock_guard<boost::mutex> lock(_mutex);
+        _stopping = true;
+    }
+    _spaceAvailable.notify_all();
+    _thread.join();
+}
+
+bool GzipLineReader::next(std::string& block)
+{
+    boost::unique_lock<boost::mutex> lock(_mutex);
+    while (_blocks.empty() && !_done)
+    {
+        _blockAvailable.wait(lock);
+    }
+    if (_blocks.empty())
+    {
+        return false;
+    }
+
+    block.swap(_blocks.front());
+    _blocks.pop_front();
+    _spaceAvailable.notify_one();
+    return true;
+}
+
+bool GzipLineReader::failed() const
+{
+    boost::lock_guard<boost::mutex> lock(_mutex);
+    return _failed;
+}
+
+bool GzipLineReader::isCompressed(const char* data, size_t size)
+{
+    return size >= 2 && static_cast<unsigned char> (data[0]) == 0x1f
+            && static_cast<unsigned char> (data[1]) == 0x8b;
+}
+
+bool GzipLineReader::push(std::string& block)
+{
+    boost::unique_lock<boost::mutex> lock(_mutex);
+    while (_blocks.size() >= MAX_QUEUED_BLOCKS && !_stopping)
+    {
+        _spaceAvailable.wait(lock);
+    }
+    if (_stopping)
+    {
+        return false;
+    }
+
+    _blocks.push_back(std::string());
+    _blocks.back().swap(block);
+    _blockAvailable.notify_one();
+    return true;
+}
+
+void GzipLineReader::finish(bool failed)
+{
+    boost::lock_guard<boost::mutex> lock(_mutex);
+    _done = true;
+    _failed = failed;
+    _blockAvailable.notify_all();
+}
+
+#ifdef HAVE_ZLIB
+
+void GzipLineReader::inflate()
+{
+    z_stream stream;
+    std::memset(&stream, 0, sizeof(stream));
+    // 32 makes zlib detect the gzip header
+    if (inflateInit2(&stream, 15 + 32) != Z_OK)
+    {
+        dbg(High) << "Cannot initialize zlib" << std::endl;
+        finish(true);
+        return;
+    }
+
+    stream.next_in = reinterpret_cast<Bytef*> (const_cast<char*> (_data));
+    stream.avail_in = 0;
+    size_t consumed = 0;
+
+    std::string block;
+    std::string output(BLOCK_SIZE, '\0');
+    bool failed = false;
+    bool stopped = false;
+
+    for (;;)
+    {
+        if (stream.avail_in == 0 && consumed < _size)
+        {
+            // avail_in is only 32 bits wide
+            size_t chunk = std::min<size_t> (_size - consumed, 1u << 30);
+            stream.next_in = reinterpret_cast<Bytef*> (const_cast<char*> (
+                    _data + consumed));
+            stream.avail_in = static_cast<uInt> (chunk);
+            consumed += chunk;
+        }
+
+        stream.next_out = reinterpret_cast<Bytef*> (&output[0]);
+        stream.avail_out = static_cast<uInt> (output.size());
+        int ret = ::inflate(&stream, Z_NO_FLUSH);
+        block.append(output.data(), output.size() - stream.avail_out);
+
+        if (ret == Z_STREAM_END)
+        {
+            // another member may follow, trailing garbage is ignored as
+            // gunzip does
+            const char *rest = reinterpret_cast<const char*> (stream.next_in);
+            if (!isCompressed(rest, _data + _size - rest))
+            {
+                break;
+            }
+            inflateReset(&stream);
+        }
+        else if (ret != Z_OK && ret != Z_BUF_ERROR)
+        {
+            dbg(High) << "Cannot inflate: " << (stream.msg ? stream.msg
+                    : "unknown error") << std::endl;
+            failed = true;
+            break;
+        }
+        else if (ret == Z_BUF_ERROR && stream.avail_in == 0 && consumed
+                == _size)
+        {
+            dbg(High) << "Compressed data is truncated" << std::endl;
+            failed = true;
+            break;
+        }
+
+        if (block.size() >= BLOCK_SIZE)
+        {
+            // the incomplete last line goes to the following block
+            size_t lineEnd = block.rfind('\n');
+            if (lineEnd != std::string::npos)
+            {
+                std::string rest(block, lineEnd + 1);
+                block.resize(lineEnd + 1);
+                if (!push(block))
+                {
+                    stopped = true;
+                    break;
+                }
+                block.swap(rest);
+            }
+        }
+    }
+
+    inflateEnd(&stream);
+    if (!failed && !stopped && !block.empty())
+    {
+        push(block);
+    }
+    finish(failed);
+}
+
+#else
+
+void GzipLineReader::inflate()
+{
+    dbg(High) << "Cannot read compressed data, built without zlib"
+            << std::endl;
+    finish(true);
+}
+
+#endif
+
+}
+}
@@ -24,15 +24,13 @@
 //
 
 #include <dataprovider/multidataprovider.h>
+#include <dataprovider/textparser.h>
 
 #include <util.h>
 
 #include <algorithm>
 #include <cmath>
-#include <fstream>
 #include <iostream>
-#include <list>
-#include <sstream>
 
 using namespace std;
 
@@ -44,10 +42,42 @@ namespace dataprovider
 
 using namespace debug;
 
-MultiDataProvider::MultiDataProvider(const std::string& filename) :
-    _filename(filename)
+namespace
 {
-    loadFromFile(_filename);
+
+/// Returns the maximum of n values, at least 0.0. The four lanes do not
+/// depend on each other, so the compiler may pack them into vector
+/// registers.
+template<typename T>
+double maxOf(const T* values, size_t n)
+{
+    T lanes[4] = { 0, 0, 0, 0 };
+
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        for (size_t lane = 0; lane < 4; ++lane)
+        {
+            lanes[lane] = std::max(lanes[lane], values[i + lane]);
+        }
+    }
+    for (; i < n; ++i)
+    {
+        lanes[0] = std::max(lanes[0], values[i]);
+    }
+
+    return std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2],
+            lanes[3]));
+}
+
+}
+
+MultiDataProvider::MultiDataProvider(const std::string& filename,
+        DataProvider::Precision precision) :
+    _filename(filename), _rows(0), _columns(0), _maxValue(0.0)
+{
+    loadFromFile(_filename, precision);
+    _maxValue = _rows ? getMaxValue(0, _rows) : 0.0;
     dbg() << "MultiDataProvider(): " << _filename << std::endl;
 }
 
@@ -58,84 +88,90 @@ MultiDataProvider::~MultiDataProvider()
 
 std::vector<double> MultiDataProvider::getData(int idx) const
 {
-    return _items[idx];
+    std::vector<double> row;
+    getRowView(idx).copyTo(row);
+    return row;
 }
 
 std::vector<std::vector<double> > MultiDataProvider::getDataVector(int idx,
         size_t size) const
 {
     std::vector<std::vector<double> > tmpVector;
+    tmpVector.reserve(size);
 
     for (size_t i = 0; i < size; ++i)
     {
-        tmpVector.push_back(_items[idx + i]);
+        tmpVector.push_back(getData(idx + i));
     }
 
     return tmpVector;
 }
 
-size_t MultiDataProvider::getDataSize() const
-{
-    return _items.size();
-}
-
 std::vector<double> MultiDataProvider::getDataSubvector(int idx, size_t start,
         size_t size) const
 {
-    std::vector<double> tmp;
-
-    std::copy(_items[idx].begin() + start,
-            _items[idx].begin() + start + size, back_inserter(tmp));
-
-    return tmp;
+    std::vector<double> part;
+    getRowView(idx, start, size).copyTo(part);
+    return part;
 }
 
-bool MultiDataProvider::loadFromFile(const std::string & filename)
+bool MultiDataProvider::loadFromFile(const std::string & filename,
+        DataProvider::Precision precision)
 {
-    ifstream inData;
-    inData.open(filename.c_str());
-    if (!inData)
+    // lines without numbers are skipped, rows of different widths are
+    // reported by the parser
+    std::vector<TableChunk> chunks;
+    size_t columns = 0;
+    if (!TextParser().parseTable(filename, chunks, columns))
+    {
         return false;
+    }
+
+    size_t count = 0;
+    for (size_t i = 0; i < chunks.size(); ++i)
+    {
+        count += chunks[i].Values.size();
+    }
 
-    size_t size = 0;
-    string line;
-    while (!inData.eof())
+    if (precision == DataProvider::SinglePrecision)
+    {
+        _floatValues.reserve(count);
+    }
+    else
+    {
+        _values.reserve(count);
+    }
+    for (size_t i = 0; i < chunks.size(); ++i)
     {
-        std::vector<double> lineValues;
-        getline(inData, line);
-        std::istringstream iss(line);
-        while( !iss.eof() )
+        const std::vector<double>& values = chunks[i].Values;
+        if (precision == DataProvider::SinglePrecision)
         {
-            double tmp = 0.0;
-            iss >> tmp;
-            lineValues.push_back(tmp);
+            _floatValues.insert(_floatValues.end(), values.begin(),
+                    values.end());
         }
-
-        _items.push_back(lineValues);
-
-        size++;
+        else
+        {
+            _values.insert(_values.end(), values.begin(), values.end());
+        }
+        std::vector<double>().swap(chunks[i].Values);
     }
-
+    _rows = columns ? count / columns : 0;
+    _columns = columns;
     return true;
 }
 
 double MultiDataProvider::getMaxValue() const
 {
-    double max = 0.0;
-
-    for(unsigned i=0; i < _items.size(); ++i)
-    {
-        double el = *(std::max_element(_items[i].begin(), _items[i].end()));
-        max = std::max(max, el);
-    }
-
-    dbg() << "[MultiDataProvider::getMaxValue()] MAX: " << max << std::endl;
-    return max;
+    dbg() << "[MultiDataProvider::getMaxValue()] MAX: " << _maxValue
+            << std::endl;
+    return _maxValue;
 }
 
-double MultiDataProvider::getValue(int idx, size_t pos) const
+double MultiDataProvider::getMaxValue(int idx, size_t size) const
 {
-    return _items[idx][pos];
+    size_t offset = idx * _columns;
+    return _floatValues.empty() ? maxOf(&_values[offset], size * _columns)
+            : maxOf(&_floatValues[offset], size * _columns);
 }
 
 }
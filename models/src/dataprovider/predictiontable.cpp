@@ -0,0 +1,161 @@
+//
+// Copyright (c) 2010 Dariusz Gadomski <dgadomski@gmail.com>
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <dataprovider/predictiontable.h>
+
+#include <util.h>
+
+#include <cstring>
+#include <fstream>
+
+namespace models
+{
+
+namespace dataprovider
+{
+
+using namespace debug;
+
+const char PredictionTable::MAGIC[8] =
+{ 'N', 'T', 'P', 'T', 'A', 'B', 'L', 'E' };
+
+PredictionTableHeader::PredictionTableHeader() :
+    Version(PredictionTable::VERSION), DatasetSize(0), DataLength(0),
+            Horizon(0), Step(1), FirstOffset(0), Count(0)
+{
+    std::memcpy(Magic, PredictionTable::MAGIC, sizeof(Magic));
+    std::memset(Algorithm, 0, sizeof(Algorithm));
+}
+
+PredictionTable::PredictionTable(const std::string& filename) :
+    _filename(filename), _header(0), _values(0)
+{
+    if (!_file.open(_filename))
+    {
+        return;
+    }
+
+    if (_file.size() < sizeof(PredictionTableHeader))
+    {
+        dbg(debug::High) << "Prediction table " << _filename
+                << " is truncated" << std::endl;
+        return;
+    }
+
+    const PredictionTableHeader *header =
+            reinterpret_cast<const PredictionTableHeader*> (_file.data());
+
+    if (std::memcmp(header->Magic, MAGIC, sizeof(MAGIC)) != 0
+            || header->Version != VERSION)
+    {
+        dbg(debug::High) << _filename << " is not a prediction table"
+                << std::endl;
+        return;
+    }
+
+    if (header->Step == 0)
+    {
+        dbg(debug::High) << "Prediction table " << _filename
+                << " has a zero step" << std::endl;
+        return;
+    }
+
+    // compared by division, Count * sizeof(double) may overflow
+    if (header->Count > (_file.size() - sizeof(PredictionTableHeader))
+            / sizeof(double))
+    {
+        dbg(debug::High) << "Prediction table " << _filename
+                << " is truncated" << std::endl;
+        return;
+    }
+
+    _header = header;
+    _values = reinterpret_cast<const double*> (_file.data()
+            + sizeof(PredictionTableHeader));
+
+    dbg(debug::Informational) << "PredictionTable(): " << _filename << " ("
+            << getAlgorithm() << ", length: " << _header->DataLength
+            << ", horizon: " << _header->Horizon << ", step: "
+            << _header->Step << ", count: " << _header->Count << ")"
+            << std::endl;
+}
+
+std::string PredictionTable::getAlgorithm() const
+{
+    return std::string(_header->Algorithm, strnlen(_header->Algorithm,
+            sizeof(_header->Algorithm)));
+}
+
+bool PredictionTable::lookup(size_t offset, size_t length, size_t horizon,
+        double& result) const
+{
+    if (!isValid() || length != _header->DataLength || horizon
+            != _header->Horizon || offset < _header->FirstOffset)
+    {
+        return false;
+    }
+
+    size_t distance = offset - _header->FirstOffset;
+    if (distance % _header->Step != 0)
+    {
+        return false;
+    }
+
+    size_t idx = distance / _header->Step;
+    if (idx >= _header->Count)
+    {
+        return false;
+    }
+
+    result = _values[idx];
+    return true;
+}
+
+bool PredictionTable::write(const std::string& filename,
+        const PredictionTableHeader& header,
+        const std::vector<double>& predictions)
+{
+    PredictionTableHeader tmpHeader(header);
+    tmpHeader.Count = predictions.size();
+
+    std::ofstream out(filename.c_str(), std::ios::out | std::ios::binary
+            | std::ios::trunc);
+    if (!out)
+    {
+        return false;
+    }
+
+    out.write(reinterpret_cast<const char*> (&tmpHeader), sizeof(tmpHeader));
+    if (!predictions.empty())
+    {
+        out.write(reinterpret_cast<const char*> (&predictions[0]),
+                predictions.size() * sizeof(double));
+    }
+
+    return out.good();
+}
+
+}
+}
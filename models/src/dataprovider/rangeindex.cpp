@@ -0,0 +1,243 @@
+//
+// Copyright (c) 2010 Dariusz Gadomski <dgadomski@gmail.com>
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <dataprovider/rangeindex.h>
+
+#include <algorithm>
+#include <limits>
+
+namespace models
+{
+
+namespace dataprovider
+{
+
+namespace
+{
+
+const double NaN = std::numeric_limits<double>::quiet_NaN();
+
+struct Less
+{
+    bool operator()(double a, double b) const
+    {
+        return a < b;
+    }
+};
+
+struct Greater
+{
+    bool operator()(double a, double b) const
+    {
+        return a > b;
+    }
+};
+
+// index of the highest set bit
+inline size_t floorLog2(size_t n)
+{
+    size_t log = 0;
+    while (n >>= 1)
+    {
+        ++log;
+    }
+    return log;
+}
+
+// the extreme of [begin, end) and result
+template<typename Better>
+inline double scan(const double* begin, const double* end, double result,
+        Better better)
+{
+    for (; begin < end; ++begin)
+    {
+        if (better(*begin, result))
+        {
+            result = *begin;
+        }
+    }
+    return result;
+}
+
+}
+
+RangeIndex::RangeIndex(const double* values, size_t size) :
+    _offset(0.0), _sums(size + 1, 0.0), _squares(size + 1, 0.0), _span(
+            BLOCK_SIZE)
+{
+    for (size_t i = 0; i < size; ++i)
+    {
+        _offset += values[i];
+    }
+    _offset = size ? _offset / size : 0.0;
+
+    for (size_t i = 0; i < size; ++i)
+    {
+        double d = values[i] - _offset;
+        _sums[i + 1] = _sums[i] + d;
+        _squares[i + 1] = _squares[i] + d * d;
+    }
+
+    // a table over b / span superblocks has at most log2(b) levels
+    size_t blocks = (size + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    _span = std::max(_span, floorLog2(blocks) + 1);
+
+    buildExtremes(values, size, _blockMinima, _minima, Less());
+    buildExtremes(values, size, _blockMaxima, _maxima, Greater());
+}
+
+template<typename Better>
+void RangeIndex::buildExtremes(const double* values, size_t size,
+        std::vector<double>& blocks, SparseTable& table, Better better)
+{
+    blocks.resize((size + BLOCK_SIZE - 1) / BLOCK_SIZE);
+    for (size_t b = 0; b < blocks.size(); ++b)
+    {
+        const double *begin = values + b * BLOCK_SIZE;
+        const double *end = values + std::min(size, (b + 1) * BLOCK_SIZE);
+        blocks[b] = *std::min_element(begin, end, better);
+    }
+
+    // only the whole superblocks are in the table, the queries scan the
+    // blocks of the last one
+    size_t supers = blocks.size() / _span;
+    table.assign(1, std::vector<double>(supers));
+    for (size_t s = 0; s < supers; ++s)
+    {
+        table[0][s] = *std::min_element(blocks.begin() + s * _span,
+                blocks.begin() + (s + 1) * _span, better);
+    }
+
+    for (size_t half = 1; 2 * half <= supers; half *= 2)
+    {
+        const std::vector<double>& prev = table.back();
+        std::vector<double> level(supers - 2 * half + 1);
+        for (size_t s = 0; s < level.size(); ++s)
+        {
+            level[s] = better(prev[s + half], prev[s]) ? prev[s + half]
+                    : prev[s];
+        }
+        table.push_back(level);
+    }
+}
+
+template<typename Better>
+double RangeIndex::query(const double* values, size_t idx, size_t size,
+        const std::vector<double>& blocks, const SparseTable& table,
+        Better better) const
+{
+    if (size == 0)
+    {
+        return NaN;
+    }
+
+    size_t end = idx + size;
+    size_t firstBlock = (idx + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    size_t lastBlock = end / BLOCK_SIZE;
+
+    // no whole block in the range
+    if (firstBlock >= lastBlock)
+    {
+        return *std::min_element(values + idx, values + end, better);
+    }
+
+    size_t firstSuper = (firstBlock + _span - 1) / _span;
+    size_t lastSuper = lastBlock / _span;
+
+    double result;
+    if (firstSuper >= lastSuper)
+    {
+        // no whole superblock in the range
+        result = *std::min_element(&blocks[firstBlock], &blocks[0]
+                + lastBlock, better);
+    }
+    else
+    {
+        // the two (possibly overlapping) power of two runs covering the
+        // superblocks
+        size_t level = floorLog2(lastSuper - firstSuper);
+        result = table[level][firstSuper];
+        double other = table[level][lastSuper - (size_t(1) << level)];
+        if (better(other, result))
+        {
+            result = other;
+        }
+
+        // partial superblocks at both ends
+        result = scan(&blocks[firstBlock], &blocks[0] + firstSuper * _span,
+                result, better);
+        result = scan(&blocks[0] + lastSuper * _span, &blocks[0] + lastBlock,
+                result, better);
+    }
+
+    // partial blocks at both ends
+    result = scan(values + idx, values + firstBlock * BLOCK_SIZE, result,
+            better);
+    return scan(values + lastBlock * BLOCK_SIZE, values + end, result, better);
+}
+
+double RangeIndex::getMean(size_t idx, size_t size) const
+{
+    if (size == 0)
+    {
+        return NaN;
+    }
+    return _offset + (_sums[idx + size] - _sums[idx]) / size;
+}
+
+double RangeIndex::getVariance(size_t idx, size_t size) const
+{
+    if (size == 0)
+    {
+        return NaN;
+    }
+    double mean = (_sums[idx + size] - _sums[idx]) / size;
+    double meanSquare = (_squares[idx + size] - _squares[idx]) / size;
+    return std::max(0.0, meanSquare - mean * mean);
+}
+
+double RangeIndex::getMin(const double* values, size_t idx, size_t size) const
+{
+    return query(values, idx, size, _blockMinima, _minima, Less());
+}
+
+double RangeIndex::getMax(const double* values, size_t idx, size_t size) const
+{
+    return query(values, idx, size, _blockMaxima, _maxima, Greater());
+}
+
+size_t RangeIndex::getMemoryUsage() const
+{
+    size_t count = _sums.size() + _squares.size() + _blockMinima.size()
+            + _blockMaxima.size();
+    for (size_t k = 0; k < _minima.size(); ++k)
+    {
+        count += _minima[k].size() + _maxima[k].size();
+    }
+    return count * sizeof(double);
+}
+
+}
+}
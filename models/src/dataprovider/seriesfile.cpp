@@ -0,0 +1,163 @@
+//
+// Copyright (c) 2010 Dariusz Gadomski <dgadomski@gmail.com>
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <dataprovider/seriesfile.h>
+
+#include <util.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+namespace models
+{
+
+namespace dataprovider
+{
+
+using namespace debug;
+
+const char SeriesFile::MAGIC[8] =
+{ 'N', 'T', 'S', 'E', 'R', 'I', 'E', 'S' };
+
+SeriesFileHeader::SeriesFileHeader() :
+    Version(SeriesFile::VERSION), ValueSize(sizeof(double)), Count(0),
+            Min(0.0), Max(0.0), Mean(0.0)
+{
+    std::memcpy(Magic, SeriesFile::MAGIC, sizeof(Magic));
+}
+
+SeriesFile::SeriesFile(const std::string& filename) :
+    _filename(filename), _header(0), _values(0), _floatValues(0)
+{
+    if (!_file.open(_filename))
+    {
+        return;
+    }
+
+    if (_file.size() < sizeof(SeriesFileHeader))
+    {
+        dbg(debug::High) << "Series file " << _filename << " is truncated"
+                << std::endl;
+        return;
+    }
+
+    const SeriesFileHeader *header =
+            reinterpret_cast<const SeriesFileHeader*> (_file.data());
+
+    if (std::memcmp(header->Magic, MAGIC, sizeof(MAGIC)) != 0
+            || header->Version != VERSION || (header->ValueSize
+            != sizeof(double) && header->ValueSize != sizeof(float)))
+    {
+        dbg(debug::High) << _filename << " is not a series file"
+                << std::endl;
+        return;
+    }
+
+    if (_file.size() < sizeof(SeriesFileHeader) + header->Count
+            * header->ValueSize)
+    {
+        dbg(debug::High) << "Series file " << _filename << " is truncated"
+                << std::endl;
+        return;
+    }
+
+    _header = header;
+    const char *values = _file.data() + sizeof(SeriesFileHeader);
+    if (header->ValueSize == sizeof(float))
+    {
+        _floatValues = reinterpret_cast<const float*> (values);
+    }
+    else
+    {
+        _values = reinterpret_cast<const double*> (values);
+    }
+
+    dbg(debug::Informational) << "SeriesFile(): " << _filename << " ("
+            << _header->Count << " values)" << std::endl;
+}
+
+bool SeriesFile::isSeriesFile(const std::string& filename)
+{
+    std::ifstream in(filename.c_str(), std::ios::in | std::ios::binary);
+    char magic[sizeof(MAGIC)];
+    if (!in.read(magic, sizeof(magic)))
+    {
+        return false;
+    }
+    return std::memcmp(magic, MAGIC, sizeof(MAGIC)) == 0;
+}
+
+bool SeriesFile::write(const std::string& filename,
+        const std::vector<double>& values, bool singlePrecision)
+{
+    SeriesFileHeader header;
+    header.ValueSize = singlePrecision ? sizeof(float) : sizeof(double);
+    header.Count = values.size();
+    if (!values.empty())
+    {
+        header.Min = *std::min_element(values.begin(), values.end());
+        header.Max = *std::max_element(values.begin(), values.end());
+
+        double sum = 0.0;
+        for (size_t i = 0; i < values.size(); ++i)
+        {
+            sum += values[i];
+        }
+        header.Mean = sum / values.size();
+
+        if (singlePrecision)
+        {
+            // rounding keeps the order, so these are the extremes of the
+            // stored values
+            header.Min = static_cast<float> (header.Min);
+            header.Max = static_cast<float> (header.Max);
+        }
+    }
+
+    std::ofstream out(filename.c_str(), std::ios::out | std::ios::binary
+            | std::ios::trunc);
+    if (!out)
+    {
+        return false;
+    }
+
+    out.write(reinterpret_cast<const char*> (&header), sizeof(header));
+    if (singlePrecision && !values.empty())
+    {
+        std::vector<float> floats(values.begin(), values.end());
+        out.write(reinterpret_cast<const char*> (&floats[0]), floats.size()
+                * sizeof(float));
+    }
+    else if (!values.empty())
+    {
+        out.write(reinterpret_cast<const char*> (&values[0]), values.size()
+                * sizeof(double));
+    }
+    return out.good();
+}
+
+}
+}
@@ -0,0 +1,204 @@
+//
+// Copyright (c) 2010 Dariusz Gadomski <dgadomski@gmail.com>
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <dataprovider/seriesstore.h>
+#include <dataprovider/compressedseries.h>
+#include <dataprovider/textparser.h>
+
+#include <util.h>
+
+#include <sstream>
+
+namespace models
+{
+
+namespace dataprovider
+{
+
+using namespace debug;
+
+namespace
+{
+
+/// Copies the rows of the chunks into a buffer holding the columns of the
+/// table one after another.
+template<typename T>
+boost::shared_ptr<std::vector<T> > toColumns(
+        const std::vector<TableChunk>& chunks, size_t width, size_t length)
+{
+    boost::shared_ptr<std::vector<T> > columns(new std::vector<T>(width
+            * length));
+    size_t row = 0;
+    for (size_t i = 0; i < chunks.size(); ++i)
+    {
+        const std::vector<double>& values = chunks[i].Values;
+        for (size_t begin = 0; begin < values.size(); begin += width, ++row)
+        {
+            for (size_t c = 0; c < width; ++c)
+            {
+                (*columns)[c * length + row] = values[begin + c];
+            }
+        }
+    }
+    return columns;
+}
+
+}
+
+SeriesStore::SeriesStore(const std::string& filename,
+        DataProvider::Precision precision) :
+    _filename(filename), _length(0)
+{
+    if (!loadFromFile(_filename, precision))
+    {
+        _ids.clear();
+        _index.clear();
+        _series.clear();
+        _length = 0;
+    }
+    dbg() << "SeriesStore(): " << _filename << " (" << _series.size()
+            << " series of " << _length << " values)" << std::endl;
+}
+
+SeriesStore::series_ptr SeriesStore::getSeries(const std::string& id) const
+{
+    std::map<std::string, size_t>::const_iterator it = _index.find(id);
+    return it != _index.end() ? _series[it->second] : series_ptr();
+}
+
+size_t SeriesStore::getMemoryUsage() const
+{
+    size_t usage = 0;
+    for (size_t i = 0; i < _series.size(); ++i)
+    {
+        usage += _series[i]->getMemoryUsage();
+    }
+    return usage;
+}
+
+bool SeriesStore::loadFromFile(const std::string& filename,
+        DataProvider::Precision precision)
+{
+    std::vector<TableChunk> chunks;
+    size_t width = 0;
+    if (!TextParser().parseTable(filename, chunks, width))
+    {
+        return false;
+    }
+
+    _ids = readIds(filename);
+    if (_ids.empty())
+    {
+        for (size_t c = 0; c < width; ++c)
+        {
+            std::ostringstream oss;
+            oss << c;
+            _ids.push_back(oss.str());
+        }
+    }
+    else if (_ids.size() != width)
+    {
+        dbg(High) << filename << " names " << _ids.size() << " series, but "
+                << "has " << width << std::endl;
+        return false;
+    }
+
+    for (size_t c = 0; c < width; ++c)
+    {
+        if (!_index.insert(std::make_pair(_ids[c], c)).second)
+        {
+            dbg(High) << "Series " << _ids[c] << " is named twice in "
+                    << filename << std::endl;
+            return false;
+        }
+    }
+
+    _length = 0;
+    for (size_t i = 0; i < chunks.size(); ++i)
+    {
+        _length += width ? chunks[i].Values.size() / width : 0;
+    }
+
+    if (precision == DataProvider::SinglePrecision)
+    {
+        boost::shared_ptr<std::vector<float> > columns(toColumns<float> (
+                chunks, width, _length));
+        std::vector<TableChunk>().swap(chunks);
+        for (size_t c = 0; c < width; ++c)
+        {
+            _series.push_back(series_ptr(new DataProvider(getName(c),
+                    DataView(&(*columns)[c * _length], _length), columns)));
+        }
+        return true;
+    }
+
+    boost::shared_ptr<std::vector<double> > columns(toColumns<double> (chunks,
+            width, _length));
+    std::vector<TableChunk>().swap(chunks);
+    for (size_t c = 0; c < width; ++c)
+    {
+        DoubleView values(&(*columns)[c * _length], _length);
+        if (precision == DataProvider::Compressed)
+        {
+            // the columns are only kept until they are encoded
+            boost::shared_ptr<const CompressedSeries> compressed(
+                    new CompressedSeries(values));
+            _series.push_back(series_ptr(new DataProvider(getName(c),
+                    compressed)));
+        }
+        else
+        {
+            _series.push_back(series_ptr(new DataProvider(getName(c),
+                    DataView(values.begin(), _length), columns)));
+        }
+    }
+    return true;
+}
+
+std::string SeriesStore::getName(size_t column) const
+{
+    return _filename + "#" + _ids[column];
+}
+
+std::vector<std::string> SeriesStore::readIds(const std::string& filename)
+{
+    std::string line(TextParser::readFirstLine(filename));
+    std::vector<std::string> ids;
+    if (line.empty() || line[0] != '#')
+    {
+        return ids;
+    }
+
+    std::istringstream iss(line.substr(1));
+    std::string id;
+    while (iss >> id)
+    {
+        ids.push_back(id);
+    }
+    return ids;
+}
+
+}
+}
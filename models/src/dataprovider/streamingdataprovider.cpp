@@ -0,0 +1,274 @@
+//
+// Copyright (c) 2010 Dariusz Gadomski <dgadomski@gmail.com>
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <dataprovider/streamingdataprovider.h>
+#include <dataprovider/textparser.h>
+
+#include <util.h>
+
+#include <algorithm>
+#include <cerrno>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <boost/bind.hpp>
+
+namespace models
+{
+
+namespace dataprovider
+{
+
+using namespace debug;
+
+const unsigned StreamingDataProvider::POLL_INTERVAL;
+
+StreamingDataProvider::StreamingDataProvider(const std::string& filename,
+        size_t capacity) :
+    _filename(filename), _buffer(std::max<size_t>(capacity, 2), 0.0),
+            _count(0), _maxValue(0.0), _stopping(false), _fd(-1),
+            _regularFile(false), _position(0)
+{
+}
+
+StreamingDataProvider::~StreamingDataProvider()
+{
+    stop();
+}
+
+bool StreamingDataProvider::start()
+{
+    if (!open())
+    {
+        return false;
+    }
+
+    // the history is read before the provider is used
+    if (_regularFile)
+    {
+        while (readAvailable() > 0)
+        {
+        }
+    }
+
+    dbg(debug::Normal) << "Following " << _filename << " (" << getCount()
+            << " values so far)" << std::endl;
+
+    _thread = boost::thread(boost::bind(&StreamingDataProvider::follow, this));
+    return true;
+}
+
+void StreamingDataProvider::stop()
+{
+    _stopping.store(true);
+    if (_thread.joinable())
+    {
+        _thread.join();
+    }
+
+    if (_fd >= 0)
+    {
+        ::close(_fd);
+        _fd = -1;
+    }
+}
+
+bool StreamingDataProvider::open()
+{
+    _fd = _filename == "-" ? ::dup(STDIN_FILENO) : ::open(_filename.c_str(),
+            O_RDONLY);
+    if (_fd < 0)
+    {
+        dbg(debug::High) << "Cannot open " << _filename << std::endl;
+        return false;
+    }
+
+    // the writer checks for stop() between the reads
+    ::fcntl(_fd, F_SETFL, ::fcntl(_fd, F_GETFL) | O_NONBLOCK);
+
+    struct stat st;
+    _regularFile = ::fstat(_fd, &st) == 0 && S_ISREG(st.st_mode);
+    _position = 0;
+    _pending.clear();
+    return true;
+}
+
+void StreamingDataProvider::append(double value)
+{
+    size_t count = _count.load(boost::memory_order_relaxed);
+    _buffer[count % _buffer.size()] = value;
+
+    if (count == 0 || value > _maxValue.load(boost::memory_order_relaxed))
+    {
+        _maxValue.store(value, boost::memory_order_relaxed);
+    }
+
+    _count.store(count + 1, boost::memory_order_release);
+}
+
+size_t StreamingDataProvider::getFirstIndex() const
+{
+    return getFirstIndex(getCount());
+}
+
+size_t StreamingDataProvider::getFirstIndex(size_t count) const
+{
+    // the slot of the oldest value is the next one to be written
+    return count < _buffer.size() ? 0 : count - _buffer.size() + 1;
+}
+
+bool StreamingDataProvider::getDataVector(size_t idx, size_t size,
+        std::vector<double>& output) const
+{
+    size_t count = getCount();
+    if (idx + size > count || idx < getFirstIndex(count))
+    {
+        return false;
+    }
+
+    output.resize(size);
+    for (size_t i = 0; i < size; ++i)
+    {
+        output[i] = _buffer[(idx + i) % _buffer.size()];
+    }
+
+    // the copy is only valid if the writer has not got to the beginning
+    // of the range while it was made
+    boost::atomic_thread_fence(boost::memory_order_acquire);
+    return idx >= getFirstIndex(_count.load(boost::memory_order_relaxed));
+}
+
+boost::shared_ptr<DataProvider> StreamingDataProvider::getSnapshot(size_t idx,
+        size_t size) const
+{
+    std::vector<double> values;
+    if (!getDataVector(idx, size, values))
+    {
+        return boost::shared_ptr<DataProvider>();
+    }
+
+    return boost::shared_ptr<DataProvider>(new DataProvider(_filename, values,
+            idx, getMaxValue()));
+}
+
+void StreamingDataProvider::follow()
+{
+    while (!_stopping.load())
+    {
+        long bytes = readAvailable();
+        if (bytes > 0)
+        {
+            continue;
+        }
+        if (bytes < 0)
+        {
+            dbg(debug::High) << "Cannot read " << _filename
+                    << ", no more values will be appended" << std::endl;
+            return;
+        }
+
+        // nothing new - the end of the file or an idle pipe
+        if (_regularFile)
+        {
+            checkRotated();
+        }
+        boost::this_thread::sleep(boost::posix_time::milliseconds(
+                POLL_INTERVAL));
+    }
+}
+
+long StreamingDataProvider::readAvailable()
+{
+    char chunk[1 << 16];
+    ssize_t bytes = ::read(_fd, chunk, sizeof(chunk));
+    if (bytes > 0)
+    {
+        _pending.append(chunk, bytes);
+        _position += bytes;
+        parseLines();
+        return bytes;
+    }
+
+    if (bytes < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno
+            == EINTR))
+    {
+        return 0;
+    }
+    return bytes;
+}
+
+void StreamingDataProvider::parseLines()
+{
+    // the last line is parsed once its end has been written
+    size_t begin = 0;
+    size_t end = 0;
+    while ((end = _pending.find('\n', begin)) != std::string::npos)
+    {
+        double value = 0.0;
+        if (TextParser::parseLine(_pending.data() + begin, _pending.data()
+                + end, value))
+        {
+            append(value);
+        }
+        begin = end + 1;
+    }
+    _pending.erase(0, begin);
+}
+
+void StreamingDataProvider::checkRotated()
+{
+    struct stat opened;
+    struct stat current;
+    if (::fstat(_fd, &opened) != 0)
+    {
+        return;
+    }
+
+    if (static_cast<size_t> (opened.st_size) < _position)
+    {
+        // truncated in place, the values appended from now on follow the
+        // ones already read
+        dbg(debug::Normal) << _filename << " truncated" << std::endl;
+        ::lseek(_fd, 0, SEEK_SET);
+        _position = 0;
+        _pending.clear();
+    }
+    else if (::stat(_filename.c_str(), &current) == 0 && (current.st_ino
+            != opened.st_ino || current.st_dev != opened.st_dev))
+    {
+        // replaced by a new file, the rest of the old one has been read
+        dbg(debug::Normal) << _filename << " replaced" << std::endl;
+        ::close(_fd);
+        if (!open())
+        {
+            _stopping.store(true);
+        }
+    }
+}
+
+}
+}
@@ -0,0 +1,470 @@
+//
+// Copyright (c) 2010 Dariusz Gadomski <dgadomski@gmail.com>
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <dataprovider/textparser.h>
+#include <dataprovider/gziplinereader.h>
+
+#include <mappedfile.h>
+#include <util.h>
+
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+
+#include <boost/bind.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/thread.hpp>
+
+namespace models
+{
+
+namespace dataprovider
+{
+
+using namespace debug;
+
+namespace
+{
+
+// files smaller than this are not worth starting a thread for
+const size_t MIN_CHUNK_SIZE = 1 << 20;
+
+// powers of ten which are exactly representable as doubles
+const double POWERS_OF_TEN[] =
+{ 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13,
+        1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+const int MAX_EXACT_EXPONENT = 22;
+const boost::uint64_t MAX_EXACT_MANTISSA = boost::uint64_t(1) << 53;
+const int MAX_MANTISSA_DIGITS = 19;
+
+inline bool isDigit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+// the characters skipped by operator>>
+inline bool isSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c
+            == '\r';
+}
+
+inline const char* skipSpace(const char* p, const char* end)
+{
+    while (p != end && isSpace(*p))
+    {
+        ++p;
+    }
+    return p;
+}
+
+inline const char* findSpace(const char* p, const char* end)
+{
+    while (p != end && !isSpace(*p))
+    {
+        ++p;
+    }
+    return p;
+}
+
+inline const char* findLineEnd(const char* p, const char* end)
+{
+    const char *lineEnd = static_cast<const char*> (std::memchr(p, '\n', end
+            - p));
+    return lineEnd ? lineEnd : end;
+}
+
+bool parseWithStream(const char* begin, const char* end, double& value)
+{
+    std::istringstream iss(std::string(begin, end));
+    double tmp = 0.0;
+    if (iss >> tmp)
+    {
+        value = tmp;
+        return true;
+    }
+    return false;
+}
+
+void parseValueChunk(const char* begin, const char* end,
+        std::vector<double>& values)
+{
+    for (const char *p = begin; p < end;)
+    {
+        const char *lineEnd = findLineEnd(p, end);
+
+        double value = 0.0;
+        if (TextParser::parseLine(p, lineEnd, value))
+        {
+            values.push_back(value);
+        }
+
+        p = lineEnd + 1;
+    }
+}
+
+void parseTableChunk(const char* begin, const char* end, TableChunk& chunk)
+{
+    for (const char *p = begin; p < end && !chunk.Ragged;)
+    {
+        const char *lineEnd = findLineEnd(p, end);
+
+        size_t size = chunk.Values.size();
+        const char *token = skipSpace(p, lineEnd);
+        while (token != lineEnd)
+        {
+            const char *tokenEnd = findSpace(token, lineEnd);
+            double value = 0.0;
+            if (!TextParser::parseNumber(token, tokenEnd, value))
+            {
+                break;
+            }
+            chunk.Values.push_back(value);
+            token = skipSpace(tokenEnd, lineEnd);
+        }
+
+        size_t width = chunk.Values.size() - size;
+        if (chunk.Width == 0)
+        {
+            chunk.Width = width;
+        }
+        else if (width != 0 && width != chunk.Width)
+        {
+            chunk.Ragged = true;
+        }
+
+        p = lineEnd + 1;
+    }
+}
+
+// Splits the file into count chunks starting at line boundaries.
+std::vector<const char*> splitLines(const MappedFile& file, unsigned count)
+{
+    const char *begin = file.data();
+    const char *end = begin + file.size();
+
+    std::vector<const char*> bounds(1, begin);
+    for (unsigned i = 1; i < count; ++i)
+    {
+        const char *p = std::max(bounds.back(), begin + file.size() * i
+                / count);
+        p = findLineEnd(p, end);
+        bounds.push_back(p == end ? end : p + 1);
+    }
+    bounds.push_back(end);
+
+    return bounds;
+}
+
+// Runs parse over every chunk into its part, the first one in the calling
+// thread.
+template<typename Part, typename Parse>
+void parseParts(const std::vector<const char*>& bounds, Parse parse,
+        std::vector<Part>& parts)
+{
+    size_t count = bounds.size() - 1;
+    parts.assign(count, Part());
+
+    boost::thread_group threads;
+    for (size_t i = 1; i < count; ++i)
+    {
+        threads.create_thread(boost::bind(parse, bounds[i], bounds[i + 1],
+                boost::ref(parts[i])));
+    }
+    parse(bounds[0], bounds[1], parts[0]);
+    threads.join_all();
+}
+
+// Runs parse over every chunk and concatenates the items.
+template<typename Item, typename Parse>
+void parseChunks(const std::vector<const char*>& bounds, Parse parse,
+        std::vector<Item>& items)
+{
+    size_t count = bounds.size() - 1;
+    std::vector<std::vector<Item> > parts;
+    parseParts(bounds, parse, parts);
+
+    size_t total = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        total += parts[i].size();
+    }
+
+    items.clear();
+    items.reserve(total);
+    for (size_t i = 0; i < count; ++i)
+    {
+        items.insert(items.end(), parts[i].begin(), parts[i].end());
+    }
+}
+
+// Parses the blocks of a compressed file as they are inflated.
+template<typename Item, typename Parse>
+bool parseBlocks(const MappedFile& file, Parse parse, std::vector<Item>& items,
+        size_t& blocks)
+{
+    GzipLineReader reader(file.data(), file.size());
+
+    items.clear();
+    std::string block;
+    for (blocks = 0; reader.next(block); ++blocks)
+    {
+        parse(block.data(), block.data() + block.size(), items);
+    }
+    return !reader.failed();
+}
+
+// Parses a compressed file block by block, a plain one in parallel chunks.
+template<typename Item, typename Parse>
+bool parseFile(const MappedFile& file, unsigned chunkCount, Parse parse,
+        std::vector<Item>& items, size_t& chunks)
+{
+    if (GzipLineReader::isCompressed(file.data(), file.size()))
+    {
+        return parseBlocks(file, parse, items, chunks);
+    }
+
+    std::vector<const char*> bounds(splitLines(file, chunkCount));
+    parseChunks(bounds, parse, items);
+    chunks = bounds.size() - 1;
+    return true;
+}
+
+}
+
+TableChunk::TableChunk() :
+    Width(0), Ragged(false)
+{
+}
+
+TextParser::TextParser(unsigned threads) :
+    _threads(threads ? threads : boost::thread::hardware_concurrency())
+{
+}
+
+bool TextParser::parseValues(const std::string& filename,
+        std::vector<double>& values) const
+{
+    MappedFile file;
+    if (!file.open(filename))
+    {
+        return false;
+    }
+
+    size_t chunks = 0;
+    if (!parseFile(file, getChunkCount(file.size()), parseValueChunk, values,
+            chunks))
+    {
+        dbg(debug::High) << "Cannot parse " << filename << std::endl;
+        return false;
+    }
+
+    dbg(debug::Informational) << "Parsed " << values.size() << " values of "
+            << filename << " in " << chunks << " chunks" << std::endl;
+    return true;
+}
+
+bool TextParser::parseTable(const std::string& filename,
+        std::vector<TableChunk>& chunks, size_t& width) const
+{
+    MappedFile file;
+    if (!file.open(filename))
+    {
+        return false;
+    }
+
+    if (GzipLineReader::isCompressed(file.data(), file.size()))
+    {
+        // the blocks are inflated one by one, they fill a single chunk
+        GzipLineReader reader(file.data(), file.size());
+        chunks.assign(1, TableChunk());
+        std::string block;
+        while (reader.next(block))
+        {
+            parseTableChunk(block.data(), block.data() + block.size(),
+                    chunks[0]);
+        }
+        if (reader.failed())
+        {
+            dbg(debug::High) << "Cannot parse " << filename << std::endl;
+            return false;
+        }
+    }
+    else
+    {
+        parseParts(splitLines(file, getChunkCount(file.size())),
+                parseTableChunk, chunks);
+    }
+
+    width = 0;
+    size_t rows = 0;
+    for (size_t i = 0; i < chunks.size(); ++i)
+    {
+        if (chunks[i].Width == 0)
+        {
+            continue;
+        }
+        if (chunks[i].Ragged || (width != 0 && chunks[i].Width != width))
+        {
+            dbg(debug::High) << "The rows of " << filename
+                    << " differ in width" << std::endl;
+            return false;
+        }
+        width = chunks[i].Width;
+        rows += chunks[i].Values.size() / width;
+    }
+
+    dbg(debug::Informational) << "Parsed " << rows << " rows of " << filename
+            << " in " << chunks.size() << " chunks" << std::endl;
+    return true;
+}
+
+std::string TextParser::readFirstLine(const std::string& filename)
+{
+    MappedFile file;
+    if (!file.open(filename))
+    {
+        return std::string();
+    }
+
+    if (GzipLineReader::isCompressed(file.data(), file.size()))
+    {
+        GzipLineReader reader(file.data(), file.size());
+        std::string block;
+        if (!reader.next(block))
+        {
+            return std::string();
+        }
+        return block.substr(0, block.find('\n'));
+    }
+
+    const char *end = file.data() + file.size();
+    return std::string(file.data(), findLineEnd(file.data(), end));
+}
+
+bool TextParser::parseLine(const char* begin, const char* end, double& value)
+{
+    const char *token = skipSpace(begin, end);
+    return parseNumber(token, findSpace(token, end), value);
+}
+
+bool TextParser::parseNumber(const char* begin, const char* end,
+        double& value)
+{
+    const char *p = begin;
+    bool negative = false;
+    if (p != end && (*p == '-' || *p == '+'))
+    {
+        negative = (*p == '-');
+        ++p;
+    }
+
+    boost::uint64_t mantissa = 0;
+    int digits = 0;
+    int exponent = 0;
+    bool any = false;
+    bool exact = true;
+
+    for (; p != end && isDigit(*p); ++p, any = true)
+    {
+        if (digits < MAX_MANTISSA_DIGITS)
+        {
+            mantissa = mantissa * 10 + (*p - '0');
+            digits += (mantissa != 0);
+        }
+        else
+        {
+            exact = false;
+        }
+    }
+
+    if (p != end && *p == '.')
+    {
+        for (++p; p != end && isDigit(*p); ++p, any = true)
+        {
+            if (digits < MAX_MANTISSA_DIGITS)
+            {
+                mantissa = mantissa * 10 + (*p - '0');
+                digits += (mantissa != 0);
+                --exponent;
+            }
+            else
+            {
+                exact = false;
+            }
+        }
+    }
+
+    if (!any)
+    {
+        return false;
+    }
+
+    if (p != end && (*p == 'e' || *p == 'E'))
+    {
+        const char *q = p + 1;
+        bool negativeExponent = false;
+        if (q != end && (*q == '-' || *q == '+'))
+        {
+            negativeExponent = (*q == '-');
+            ++q;
+        }
+
+        int e = 0;
+        bool expDigits = false;
+        for (; q != end && isDigit(*q); ++q, expDigits = true)
+        {
+            e = std::min(e * 10 + (*q - '0'), 10000);
+        }
+
+        exact = exact && expDigits;
+        exponent += negativeExponent ? -e : e;
+        p = q;
+    }
+
+    // anything unusual is left to the stream, so the results never differ
+    if (p != end || !exact || mantissa > MAX_EXACT_MANTISSA || exponent
+            > MAX_EXACT_EXPONENT || exponent < -MAX_EXACT_EXPONENT)
+    {
+        return parseWithStream(begin, end, value);
+    }
+
+    // both operands are exact, so the single rounding of the division or
+    // multiplication gives the correctly rounded value
+    double result = static_cast<double> (mantissa);
+    result = exponent < 0 ? result / POWERS_OF_TEN[-exponent] : result
+            * POWERS_OF_TEN[exponent];
+    value = negative ? -result : result;
+    return true;
+}
+
+unsigned TextParser::getChunkCount(size_t size) const
+{
+    size_t count = std::min<size_t>(_threads, size / MIN_CHUNK_SIZE);
+    return static_cast<unsigned> (std::max<size_t>(count, 1));
+}
+
+}
+}
@@ -27,7 +27,9 @@
 
 #include <util.h>
 
+#include <algorithm>
 #include <cmath>
+#include <limits>
 
 namespace models
 {
@@ -36,95 +38,244 @@ namespace grey
 using namespace debug;
 
 Grey::Grey() :
-    _ag(0.0), _ug(0.0)
+    _ag(0.0), _ug(0.0), _windowHead(0), _cumulativeHead(0), _sumZ(0.0), _sumZ2(0.0), _sumX(0.0), _sumZX(0.0),
+            _slid(0)
 {
 
 }
 
-void Grey::provideInput(const std::vector<double>& input, unsigned horizon)
+void Grey::provideInput(const DataView& input, unsigned horizon)
 {
-    _x0 = input;
+    if (input.isSinglePrecision())
+    {
+        fit(input.floats());
+    }
+    else
+    {
+        fit(input.doubles());
+    }
+}
+
+template<typename View>
+void Grey::fit(const View& input)
+{
+    printSeq("[GREY] input: ", input);
+
+    ArenaVector x1((ArenaAllocator<double> (_arena)));
+    performAGO(input, x1);
 
-    printSeq("[GREY] input: ", _x0);
+    printSeq("[GREY] AGO: ", x1);
 
-    _x1 = performAGO(_x0);
+    ArenaVector z1((ArenaAllocator<double> (_arena)));
+    applyMean(x1, z1);
 
-    printSeq("[GREY] AGO: ", _x1);
+    printSeq("[GREY] MEAN: ", z1);
 
-    _z1 = applyMean(_x1);
+    matrixOperations(input, z1);
 
-    printSeq("[GREY] MEAN: ", _z1);
+    // reuses the storage of the previous window
+    _window.assign(input.begin(), input.end());
+    _windowHead = 0;
+    resetSlidingSums();
+}
 
-    matrixOperations();
+inline double Grey::windowAt(size_t idx) const
+{
+    return _window[(_windowHead + idx) % _window.size()];
 }
 
-const std::vector<double> Grey::performAGO(const std::vector<double>& input)
+inline double Grey::cumulativeAt(size_t idx) const
 {
-    std::vector<double> vecAGO;
+    return _cumulative[(_cumulativeHead + idx) % _cumulative.size()];
+}
 
-    for (size_t i = 0; i < input.size(); ++i)
+bool Grey::supportsSliding() const
+{
+    return true;
+}
+
+void Grey::slideInput(const DataView& newValues, unsigned horizon)
+{
+    if (newValues.isSinglePrecision())
     {
-        double sum = 0;
-        for (size_t j = 0; j <= i; ++j)
+        slide(newValues.floats());
+    }
+    else
+    {
+        slide(newValues.doubles());
+    }
+}
+
+template<typename View>
+void Grey::slide(const View& newValues)
+{
+    size_t n = _window.size();
+
+    if (newValues.size() >= n && n >= 2)
+    {
+        // nothing of the old window is left
+        fit(newValues.subview(newValues.size() - n, n));
+        return;
+    }
+    if (n < 2)
+    {
+        // too short to slide, the window grows to two values
+        ArenaVector input(_window.begin(), _window.end(),
+                ArenaAllocator<double> (_arena));
+        input.insert(input.end(), newValues.begin(), newValues.end());
+        size_t keep = std::min<size_t>(2, input.size());
+        if (keep > 0)
         {
-            sum += input[j];
+            fit(DoubleView(&input[0] + input.size() - keep, keep));
         }
-        vecAGO.push_back(sum);
+        return;
+    }
+
+    for (size_t i = 0; i < newValues.size(); ++i)
+    {
+        double value = newValues[i];
+        double last = cumulativeAt(n);
+        double cumulative = last + value;
+
+        // the term of the value leaving the window
+        double leavingCumulative = cumulativeAt(1);
+        double leavingNext = cumulativeAt(2);
+        double leavingValue = windowAt(1);
+
+        addTerm(last, cumulative, value, 1);
+        addTerm(leavingCumulative, leavingNext, leavingValue, -1);
+
+        // the new values take the places of the oldest ones
+        _cumulative[_cumulativeHead] = cumulative;
+        _cumulativeHead = (_cumulativeHead + 1) % _cumulative.size();
+        _window[_windowHead] = value;
+        _windowHead = (_windowHead + 1) % _window.size();
     }
 
-    return vecAGO;
+    // start from scratch once in a while so that the rounding errors of
+    // the subtractions do not accumulate
+    _slid += newValues.size();
+    if (_slid >= n)
+    {
+        resetSlidingSums();
+    }
+
+    // the sums are based on the series accumulated from the last reset,
+    // shift them so that the accumulation starts at the window
+    double b = cumulativeAt(0);
+    double m = n - 1;
+    double C = _sumZ - m * b;
+    double D = _sumX;
+    double E = _sumZX - b * _sumX;
+    double F = _sumZ2 - 2 * b * _sumZ + m * b * b;
+
+    solveParameters(C, D, E, F, n);
 }
 
-const std::vector<double> Grey::applyMean(const std::vector<double> & input)
+void Grey::resetSlidingSums()
 {
-    std::vector<double> vecMEAN;
+    size_t n = _window.size();
+    _cumulative.resize(n + 1);
+    _cumulativeHead = 0;
+    _cumulative[0] = 0.0;
 
-    for (size_t i = 1; i < input.size(); ++i)
+    double sum = 0.0;
+    for (size_t i = 0; i < n; ++i)
+    {
+        sum += windowAt(i);
+        _cumulative[i + 1] = sum;
+    }
+
+    _sumZ = _sumZ2 = _sumX = _sumZX = 0.0;
+    for (size_t p = 0; p + 1 < n; ++p)
     {
-        vecMEAN.push_back(0.5 * (input[i] + input[i - 1]));
+        addTerm(_cumulative[p + 1], _cumulative[p + 2], windowAt(p + 1), 1);
     }
 
-    return vecMEAN;
+    _slid = 0;
+}
+
+void Grey::addTerm(double cumulative, double nextCumulative, double nextValue,
+        int sign)
+{
+    double z = 0.5 * (cumulative + nextCumulative);
+    _sumZ += sign * z;
+    _sumZ2 += sign * z * z;
+    _sumX += sign * nextValue;
+    _sumZX += sign * z * nextValue;
+}
+
+template<typename View>
+void Grey::performAGO(const View& input, ArenaVector& output)
+{
+    output.resize(input.size());
+
+    double sum = 0;
+    for (size_t i = 0; i < input.size(); ++i)
+    {
+        sum += input[i];
+        output[i] = sum;
+    }
+}
+
+void Grey::applyMean(const ArenaVector& input, ArenaVector& output)
+{
+    output.resize(input.empty() ? 0 : input.size() - 1);
+
+    for (size_t i = 1; i < input.size(); ++i)
+    {
+        output[i - 1] = 0.5 * (input[i] + input[i - 1]);
+    }
 }
 
 double Grey::getPrediction(unsigned horizon)
 {
-    double p1 = (_x0[0] - _ug / _ag);
-    double p2 = std::exp(-_ag * (_x0.size() + horizon - 1));
+    if (_window.empty())
+    {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+
+    double p1 = (windowAt(0) - _ug / _ag);
+    double p2 = std::exp(-_ag * (_window.size() + horizon - 1));
     double p3 = (1 - std::exp(_ag));
     double result = p1 * p2 * p3;
     return result;
 }
 
-void Grey::matrixOperations()
+template<typename View>
+void Grey::matrixOperations(const View& x0, const ArenaVector& z1)
 {
-    printSeq("[GREY] _z1: ", _z1);
+    printSeq("[GREY] z1: ", z1);
 
     double C = 0.0;
-    for (unsigned i = 0; i < _z1.size(); ++i)
+    for (unsigned i = 0; i < z1.size(); ++i)
     {
-        C += _z1[i];
+        C += z1[i];
     }
 
     double D = 0.0;
-    for (unsigned i = 1; i < _x0.size(); ++i)
+    for (unsigned i = 1; i < x0.size(); ++i)
     {
-        D += _x0[i];
+        D += x0[i];
     }
 
     double E = 0.0;
-    for (unsigned i = 1; i < _x0.size(); ++i)
+    for (unsigned i = 1; i < x0.size(); ++i)
     {
-        E += _z1[i - 1] * _x0[i];
+        E += z1[i - 1] * x0[i];
     }
 
     double F = 0.0;
-    for (unsigned i = 0; i < _z1.size(); ++i)
+    for (unsigned i = 0; i < z1.size(); ++i)
     {
-        F += _z1[i] * _z1[i];
+        F += z1[i] * z1[i];
     }
 
-    double n = _x0.size();
+    solveParameters(C, D, E, F, x0.size());
+}
+
+void Grey::solveParameters(double C, double D, double E, double F, double n)
+{
     _ag = (C * D - (n - 1) * E) / ((n - 1) * F - C * C);
     _ug = (D * F - C * E) / (n * F - 1 - C * C);
 }
@@ -0,0 +1,115 @@
+//
+// Copyright (c) 2010 Dariusz Gadomski <dgadomski@gmail.com>
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <mappedfile.h>
+
+#include <util.h>
+
+#include <algorithm>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace models
+{
+
+using namespace debug;
+
+MappedFile::MappedFile() :
+    _data(0), _size(0)
+{
+}
+
+MappedFile::MappedFile(const std::string& filename) :
+    _data(0), _size(0)
+{
+    open(filename);
+}
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+bool MappedFile::open(const std::string& filename)
+{
+    close();
+
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        dbg(debug::High) << "Cannot open " << filename << std::endl;
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0)
+    {
+        ::close(fd);
+        return false;
+    }
+
+    void *addr = mmap(0, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+
+    if (addr == MAP_FAILED)
+    {
+        dbg(debug::High) << "Cannot map " << filename << std::endl;
+        return false;
+    }
+
+    _data = addr;
+    _size = st.st_size;
+    return true;
+}
+
+void MappedFile::prefetch(size_t offset, size_t length) const
+{
+    if (!_data || offset >= _size)
+    {
+        return;
+    }
+
+    // madvise() takes page aligned addresses
+    static const size_t pageSize = sysconf(_SC_PAGESIZE);
+    size_t begin = offset / pageSize * pageSize;
+    size_t end = std::min(offset + length, _size);
+    madvise(static_cast<char*> (_data) + begin, end - begin, MADV_WILLNEED);
+}
+
+void MappedFile::close()
+{
+    if (_data)
+    {
+        munmap(_data, _size);
+        _data = 0;
+        _size = 0;
+    }
+}
+
+}
@@ -0,0 +1,73 @@
+//
+// Copyright (c) 2010 Dariusz Gadomski <dgadomski@gmail.com>
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <modelfactory.h>
+
+#include <arima/arima.h>
+#include <chaos/chaos.h>
+#include <grey/grey.h>
+#include <neural/neuralnet.h>
+
+#include <vector>
+
+namespace models
+{
+
+const char* ModelFactory::NEURAL_NET_FILE = "learning.net";
+
+AbstractModel* ModelFactory::createModel(const std::string& algorithm,
+        const dataprovider::DataProvider& dataProvider)
+{
+    AbstractModel *model = 0;
+
+    if (algorithm == "arima")
+    {
+        arima::Arima *arima = new arima::Arima();
+        std::vector<int> order;
+        order.push_back(1);
+        order.push_back(2);
+        order.push_back(1);
+        arima->setOrder(order);
+        model = arima;
+    }
+    else if (algorithm == "grey")
+    {
+        model = new grey::Grey();
+    }
+    else if (algorithm == "chaos")
+    {
+        model = new chaos::Chaos(3, 1);
+    }
+    else if (algorithm == "neural")
+    {
+        neural::NeuralNet *net = neural::NeuralNet::load(NEURAL_NET_FILE);
+        net->setScale(1.0 / dataProvider.getMaxValue());
+        model = net;
+    }
+
+    return model;
+}
+
+}
@@ -49,19 +49,15 @@ InputLayer::InputLayer(int num) :
 
 void InputLayer::insertInput(const std::vector<double> & input)
 {
-    std::vector<double> inputBuffer;
-
+    // the neurons take the newest values of the input
+    size_t first = 0;
     if (input.size() > neuronCount())
     {
-        std::copy(input.begin() + input.size() - neuronCount(), input.end(),
-                std::back_inserter(inputBuffer));
-    }
-    else
-    {
-        std::copy(input.begin(), input.end(), std::back_inserter(inputBuffer));
+        first = input.size() - neuronCount();
     }
 
     _buffer.clear();
+    _neuronInput.resize(1);
 
 //  for (std::vector<boost::shared_ptr<Neuron> >::iterator it = _neurons.begin(); it
 //          != _neurons.end(); ++it)
@@ -69,10 +65,9 @@ void InputLayer::insertInput(const std::vector<double> & input)
     {
         boost::shared_ptr<Neuron> neuron = _neurons[i];
 
-        std::vector<double> tmpInput;
-        tmpInput.push_back(inputBuffer[i]);
+        _neuronInput[0] = input[first + i];
 
-        neuron->insertInput(tmpInput, _bias, *_activationFunction);
+        neuron->insertInput(_neuronInput, _bias, *_activationFunction);
         _buffer.push_back(neuron->getOutput());
     }
 
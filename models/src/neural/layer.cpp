@@ -87,7 +87,7 @@ void Layer::stepDone()
     _callback(this);
 }
 
-std::vector<double> Layer::getOutput() const
+const std::vector<double>& Layer::getOutput() const
 {
     return _buffer;
 }
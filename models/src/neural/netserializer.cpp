@@ -101,7 +101,11 @@ void NetSerializer::saveToFile(const boost::shared_ptr<NeuralNet> & net,
 NeuralNet * NetSerializer::loadFromFile(const string& filename)
 {
     ifstream infile(filename.c_str());
+    return loadFromStream(infile);
+}
 
+NeuralNet * NetSerializer::loadFromStream(istream& infile)
+{
     string line;
 
     NeuralNet *net = new NeuralNet;
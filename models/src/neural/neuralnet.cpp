@@ -30,6 +30,7 @@
 #include <neural/netserializer.h>
 #include <util.h>
 
+#include <algorithm>
 #include <iostream>
 
 namespace models
@@ -39,6 +40,34 @@ namespace neural
 
 using namespace debug;
 
+namespace
+{
+
+template<typename View>
+void scaleValues(const View& values, double scale, double* output)
+{
+    for (size_t i = 0; i < values.size(); ++i)
+    {
+        output[i] = values[i] * scale;
+    }
+}
+
+/// Writes the values multiplied by scale to output, the storage type of
+/// the view is checked once.
+void scaleValues(const DataView& values, double scale, double* output)
+{
+    if (values.isSinglePrecision())
+    {
+        scaleValues(values.floats(), scale, output);
+    }
+    else
+    {
+        scaleValues(values.doubles(), scale, output);
+    }
+}
+
+}
+
 NeuralNet::NeuralNet() :
     _mode(Off), _numLearningSteps(0), _learningFactor(BASE_LEARNING_FACTOR),
             _scale(1.0)
@@ -55,6 +84,7 @@ NeuralNet::~NeuralNet()
 void NeuralNet::setLayers(const std::vector<boost::shared_ptr<Layer> >& layers)
 {
     _layers = layers;
+    _dense.clear();
 
     boost::shared_ptr<Layer> prevLayer;
     for (std::vector<boost::shared_ptr<Layer> >::iterator it = _layers.begin(); it
@@ -76,12 +106,11 @@ void NeuralNet::setLayers(const std::vector<boost::shared_ptr<Layer> >& layers)
     }
 }
 
-void NeuralNet::provideInput(const std::vector<double>& inputValues,
-        unsigned horizon)
+void NeuralNet::provideInput(const DataView& inputValues, unsigned horizon)
 {
     _mode = Computation;
     _resultBuffer.clear();
-    _inputBuffer = scaleVector(inputValues);
+    scaleVector(inputValues, _inputBuffer);
 
     _layers[0]->insertInput(_inputBuffer);
 }
@@ -90,8 +119,9 @@ void NeuralNet::trainingStep(const std::vector<double>& inputValues,
         std::vector<double>& expectedOutput)
 {
     _mode = Training;
-    _expectedOutput = scaleVector(expectedOutput);
-    _inputBuffer = scaleVector(inputValues);
+    _dense.clear();
+    scaleVector(expectedOutput, _expectedOutput);
+    scaleVector(inputValues, _inputBuffer);
     _resultBuffer.clear();
     _layers[0]->insertInput(_inputBuffer);
 
@@ -122,7 +152,7 @@ void NeuralNet::stepDoneCallback(Layer *layer)
 
 void NeuralNet::calculateErrorValues(Layer *outputLayer)
 {
-    std::vector<double> output = outputLayer->getOutput();
+    const std::vector<double>& output = outputLayer->getOutput();
     std::vector<double> outputErrors;
     for (size_t i = 0; i < outputLayer->neuronCount(); ++i)
     {
@@ -202,6 +232,12 @@ NeuralNet *NeuralNet::load(const std::string & filename)
     return ns.loadFromFile(filename);
 }
 
+NeuralNet *NeuralNet::load(std::istream & input)
+{
+    NetSerializer ns;
+    return ns.loadFromStream(input);
+}
+
 double NeuralNet::getPrediction(unsigned horizon)
 {
     while (_resultBuffer.size() < horizon && !_resultBuffer.empty())
@@ -222,17 +258,168 @@ double NeuralNet::getPrediction(unsigned horizon)
     return predVal / _scale;
 }
 
-std::vector<double> NeuralNet::scaleVector(const std::vector<double> & vec) const
+bool NeuralNet::supportsBatch() const
+{
+    return true;
+}
+
+void NeuralNet::predictBatch(const std::vector<DataView>& inputs,
+        const std::vector<unsigned>& horizons, std::vector<double>& predictions)
+{
+    predictions.assign(inputs.size(), 0.0);
+    if (inputs.empty() || _layers.empty())
+    {
+        return;
+    }
+
+    if (_dense.empty())
+    {
+        compileLayers();
+    }
+
+    size_t batchSize = inputs.size();
+    size_t inputWidth = _dense.front().Neurons;
+    unsigned maxHorizon = 1;
+    for (size_t b = 0; b < batchSize; ++b)
+    {
+        maxHorizon = std::max(maxHorizon, horizons[b]);
+    }
+
+    // scaled input windows of all requests stored one after another
+    ArenaAllocator<double> alloc(_arena);
+    std::vector<size_t, ArenaAllocator<size_t> > starts(batchSize + 1, 0,
+            ArenaAllocator<size_t> (_arena));
+    for (size_t b = 0; b < batchSize; ++b)
+    {
+        starts[b + 1] = starts[b] + inputs[b].size();
+    }
+    ArenaVector windows(starts[batchSize], 0.0, alloc);
+    for (size_t b = 0; b < batchSize; ++b)
+    {
+        if (!inputs[b].empty())
+        {
+            scaleValues(inputs[b], _scale, &windows[starts[b]]);
+        }
+    }
+
+    ArenaVector firstResults(batchSize, 0.0, alloc);
+    ArenaVector values(alloc);
+    ArenaVector output(alloc);
+    for (unsigned step = 1; step <= maxHorizon; ++step)
+    {
+        // the input layer takes the newest inputWidth values of the window
+        values.assign(batchSize * inputWidth, 0.0);
+        for (size_t b = 0; b < batchSize; ++b)
+        {
+            ArenaVector::iterator begin = windows.begin() + starts[b];
+            ArenaVector::iterator end = windows.begin() + starts[b + 1];
+            if (step > 1 && begin != end)
+            {
+                // same feedback as in getPrediction()
+                std::rotate(begin, begin + 1, end);
+                *(end - 1) = firstResults[b];
+            }
+            size_t count = std::min<size_t>(inputWidth, end - begin);
+            std::copy(end - count, end, values.begin() + b * inputWidth);
+        }
+
+        forwardBatch(values, output, batchSize, inputWidth);
+
+        for (size_t b = 0; b < batchSize; ++b)
+        {
+            double result = values[b * _dense.back().Neurons];
+            if (step == 1)
+            {
+                firstResults[b] = result;
+            }
+            if (step == std::max(1u, horizons[b]))
+            {
+                predictions[b] = result / _scale;
+            }
+        }
+    }
+}
+
+void NeuralNet::compileLayers()
 {
-    std::vector<double> tmpVec;
-    tmpVec.reserve(vec.size());
+    _dense.clear();
+    _dense.resize(_layers.size());
+
+    for (size_t l = 0; l < _layers.size(); ++l)
+    {
+        Layer& layer = *_layers[l];
+        DenseLayer& dense = _dense[l];
+        dense.Neurons = layer.neuronCount();
+        dense.Bias = layer.bias();
+        dense.Function = layer.activationFunction();
+        dense.SingleInput = (layer.getType() == Layer::Input);
+
+        for (size_t j = 0; j < dense.Neurons; ++j)
+        {
+            dense.Width = std::max(dense.Width, layer[j]->getNumberInputs());
+        }
+
+        // neurons with fewer weights than the widest one ignore the
+        // remaining inputs, just like Neuron::insertInput() does
+        dense.Weights.assign(dense.Neurons * dense.Width, 0.0);
+        for (size_t j = 0; j < dense.Neurons; ++j)
+        {
+            Neuron& neuron = *layer[j];
+            for (size_t i = 0; i < neuron.getNumberInputs(); ++i)
+            {
+                dense.Weights[j * dense.Width + i] = neuron[i];
+            }
+        }
+    }
+}
 
-    BOOST_FOREACH( double val, vec )
+void NeuralNet::forwardBatch(ArenaVector& values, ArenaVector& output,
+        size_t batchSize, size_t width) const
+{
+    for (size_t l = 0; l < _dense.size(); ++l)
     {
-        tmpVec.push_back(val*_scale);
+        const DenseLayer& layer = _dense[l];
+        const ActivationFunction& af = *layer.Function;
+        output.resize(batchSize * layer.Neurons);
+
+        for (size_t b = 0; b < batchSize; ++b)
+        {
+            const double *in = &values[b * width];
+            double *out = &output[b * layer.Neurons];
+
+            for (size_t j = 0; j < layer.Neurons; ++j)
+            {
+                const double *weights = &layer.Weights[j * layer.Width];
+                double sum = 0.0;
+                if (layer.SingleInput && layer.Width > 0)
+                {
+                    sum = in[j] * weights[0];
+                }
+                else
+                {
+                    for (size_t i = 0; i < layer.Width; ++i)
+                    {
+                        sum += in[i] * weights[i];
+                    }
+                }
+                out[j] = af(sum - layer.Bias);
+            }
+        }
+
+        values.swap(output);
+        width = layer.Neurons;
     }
+}
 
-    return tmpVec;
+void NeuralNet::scaleVector(const DataView& vec,
+        std::vector<double>& result) const
+{
+    // the result is one of the members, its storage is reused
+    result.resize(vec.size());
+    if (!result.empty())
+    {
+        scaleValues(vec, _scale, &result[0]);
+    }
 }
 
 }
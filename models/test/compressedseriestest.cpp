@@ -0,0 +1,179 @@
+//
+// Copyright (c) 2010 Dariusz Gadomski <dgadomski@gmail.com>
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#define BOOST_TEST_MODULE CompressedSeries
+#include <boost/test/included/unit_test.hpp>
+
+#include <dataprovider/compressedseries.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+using namespace models::dataprovider;
+
+namespace
+{
+
+const size_t B = CompressedSeries::BLOCK_SIZE;
+
+inline bool isNaN(double value)
+{
+    return value != value;
+}
+
+std::vector<double> makeSeries(size_t size, unsigned seed)
+{
+    std::srand(seed);
+    std::vector<double> values(size);
+    for (size_t i = 0; i < size; ++i)
+    {
+        values[i] = 1e6 + std::rand() % 10000 / 100.0;
+    }
+    return values;
+}
+
+double scanMean(const std::vector<double>& values, size_t idx, size_t size)
+{
+    double sum = 0.0;
+    for (size_t i = idx; i < idx + size; ++i)
+    {
+        sum += values[i];
+    }
+    return sum / size;
+}
+
+double scanVariance(const std::vector<double>& values, size_t idx,
+        size_t size)
+{
+    double mean = scanMean(values, idx, size);
+    double sum = 0.0;
+    for (size_t i = idx; i < idx + size; ++i)
+    {
+        sum += (values[i] - mean) * (values[i] - mean);
+    }
+    return sum / size;
+}
+
+void checkRange(const CompressedSeries& series,
+        const std::vector<double>& values, size_t idx, size_t size)
+{
+    BOOST_TEST_CONTEXT("range (" << idx << ", " << size << ") of "
+            << values.size())
+    {
+        BOOST_CHECK_EQUAL(series.getMin(idx, size), *std::min_element(
+                values.begin() + idx, values.begin() + idx + size));
+        BOOST_CHECK_EQUAL(series.getMax(idx, size), *std::max_element(
+                values.begin() + idx, values.begin() + idx + size));
+
+        double mean = scanMean(values, idx, size);
+        BOOST_CHECK_SMALL(series.getMean(idx, size) - mean, 1e-12 * mean);
+
+        double variance = scanVariance(values, idx, size);
+        BOOST_CHECK_SMALL(series.getVariance(idx, size) - variance, 1e-9
+                + 1e-9 * variance);
+    }
+}
+
+}
+
+BOOST_AUTO_TEST_CASE(decodesLosslessly)
+{
+    std::vector<double> values(makeSeries(5 * B + 7, 1));
+    CompressedSeries series(values);
+
+    std::vector<double> decoded(values.size());
+    series.decode(0, values.size(), &decoded[0]);
+    BOOST_CHECK(decoded == values);
+    BOOST_CHECK_EQUAL(series.getValue(2 * B + 1), values[2 * B + 1]);
+}
+
+BOOST_AUTO_TEST_CASE(randomRanges)
+{
+    std::vector<double> values(makeSeries(10007, 2));
+    CompressedSeries series(values);
+
+    for (int i = 0; i < 5000; ++i)
+    {
+        size_t idx = std::rand() % values.size();
+        size_t size = 1 + std::rand() % (values.size() - idx);
+        checkRange(series, values, idx, size);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(edgeRanges)
+{
+    std::vector<double> values(makeSeries(4 * B + 5, 3));
+    CompressedSeries series(values);
+
+    size_t edges[] = { 0, 1, B - 1, B, B + 1, 2 * B, 3 * B + 2, 4 * B,
+            4 * B + 4, 4 * B + 5 };
+    size_t count = sizeof(edges) / sizeof(edges[0]);
+    for (size_t i = 0; i < count; ++i)
+    {
+        for (size_t j = i + 1; j < count; ++j)
+        {
+            checkRange(series, values, edges[i], edges[j] - edges[i]);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(emptyRanges)
+{
+    std::vector<double> values(makeSeries(2 * B, 4));
+    CompressedSeries series(values);
+
+    BOOST_CHECK(isNaN(series.getMean(B, 0)));
+    BOOST_CHECK(isNaN(series.getVariance(B, 0)));
+    BOOST_CHECK(isNaN(series.getMin(0, 0)));
+    BOOST_CHECK(isNaN(series.getMax(values.size(), 0)));
+
+    CompressedSeries empty((std::vector<double>()));
+    BOOST_CHECK_EQUAL(empty.getCount(), 0u);
+    BOOST_CHECK(isNaN(empty.getMean(0, 0)));
+}
+
+BOOST_AUTO_TEST_CASE(restoresFromEncoding)
+{
+    std::vector<double> values(makeSeries(3 * B + 11, 5));
+    CompressedSeries series(values);
+
+    std::vector<boost::uint64_t> bits(series.getBits());
+    std::vector<boost::uint64_t> blocks(series.getBlocks());
+    CompressedSeries restored(bits, blocks, series.getCount());
+    BOOST_CHECK(bits.empty());
+
+    std::vector<double> decoded(values.size());
+    restored.decode(0, values.size(), &decoded[0]);
+    BOOST_CHECK(decoded == values);
+    checkRange(restored, values, 5, 2 * B);
+
+    // a block count which does not match the values is rejected
+    std::vector<boost::uint64_t> moreBits(series.getBits());
+    std::vector<boost::uint64_t> moreBlocks(series.getBlocks());
+    CompressedSeries corrupt(moreBits, moreBlocks, values.size() + B);
+    BOOST_CHECK_EQUAL(corrupt.getCount(), 0u);
+}
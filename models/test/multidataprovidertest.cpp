@@ -0,0 +1,110 @@
+//
+// Copyright (c) 2010 Dariusz Gadomski <dgadomski@gmail.com>
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#define BOOST_TEST_MODULE MultiDataProvider
+#include <boost/test/included/unit_test.hpp>
+
+#include <dataprovider/multidataprovider.h>
+
+#include <cstdio>
+#include <string>
+
+#include <unistd.h>
+
+using namespace models::dataprovider;
+
+namespace
+{
+
+/// Table written to a temporary file, removed with it.
+class TableFile
+{
+public:
+    explicit TableFile(const std::string& contents)
+    {
+        char name[] = "/tmp/multidataproviderXXXXXX";
+        int fd = mkstemp(name);
+        BOOST_REQUIRE(fd >= 0);
+        BOOST_REQUIRE_EQUAL(write(fd, contents.data(), contents.size()),
+                ssize_t(contents.size()));
+        close(fd);
+        _name = name;
+    }
+
+    ~TableFile()
+    {
+        std::remove(_name.c_str());
+    }
+
+    const std::string& getName() const
+    {
+        return _name;
+    }
+
+private:
+    std::string _name;
+};
+
+void checkTable(const MultiDataProvider& data)
+{
+    BOOST_REQUIRE_EQUAL(data.getDataSize(), 3u);
+    BOOST_REQUIRE_EQUAL(data.getColumnCount(), 3u);
+    for (int row = 0; row < 3; ++row)
+    {
+        for (size_t col = 0; col < 3; ++col)
+        {
+            BOOST_CHECK_EQUAL(data.getValue(row, col), 3 * row + col + 1);
+        }
+    }
+    BOOST_CHECK_EQUAL(data.getMaxValue(), 9.0);
+}
+
+}
+
+BOOST_AUTO_TEST_CASE(skipsBlankLines)
+{
+    TableFile file("1 2 3\n\n4 5 6\n  \t\n7 8 9\n\n");
+
+    checkTable(MultiDataProvider(file.getName()));
+    checkTable(MultiDataProvider(file.getName(),
+            DataProvider::SinglePrecision));
+}
+
+BOOST_AUTO_TEST_CASE(readsTrailingLine)
+{
+    // the last line has no line break
+    TableFile file("1 2 3\n4 5 6\n\n7 8 9");
+
+    checkTable(MultiDataProvider(file.getName()));
+}
+
+BOOST_AUTO_TEST_CASE(rejectsRaggedRows)
+{
+    TableFile file("1 2 3\n4 5\n7 8 9\n");
+
+    MultiDataProvider data(file.getName());
+    BOOST_CHECK_EQUAL(data.getDataSize(), 0u);
+    BOOST_CHECK_EQUAL(data.getColumnCount(), 0u);
+}
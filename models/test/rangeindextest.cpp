@@ -0,0 +1,223 @@
+//
+// Copyright (c) 2010 Dariusz Gadomski <dgadomski@gmail.com>
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#define BOOST_TEST_MODULE RangeIndex
+#include <boost/test/included/unit_test.hpp>
+
+#include <dataprovider/rangeindex.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+using namespace models::dataprovider;
+
+namespace
+{
+
+const size_t B = RangeIndex::BLOCK_SIZE;
+
+inline bool isNaN(double value)
+{
+    return value != value;
+}
+
+// a trace-like series: a large level with noise, so that the variance of
+// a window is small against the square of its mean
+std::vector<double> makeSeries(size_t size, unsigned seed)
+{
+    std::srand(seed);
+    std::vector<double> values(size);
+    for (size_t i = 0; i < size; ++i)
+    {
+        values[i] = 1e6 + std::rand() % 10000 / 100.0;
+    }
+    return values;
+}
+
+double scanMean(const std::vector<double>& values, size_t idx, size_t size)
+{
+    double sum = 0.0;
+    for (size_t i = idx; i < idx + size; ++i)
+    {
+        sum += values[i];
+    }
+    return sum / size;
+}
+
+double scanVariance(const std::vector<double>& values, size_t idx,
+        size_t size)
+{
+    double mean = scanMean(values, idx, size);
+    double sum = 0.0;
+    for (size_t i = idx; i < idx + size; ++i)
+    {
+        sum += (values[i] - mean) * (values[i] - mean);
+    }
+    return sum / size;
+}
+
+void checkRange(const RangeIndex& index, const std::vector<double>& values,
+        size_t idx, size_t size)
+{
+    BOOST_TEST_CONTEXT("range (" << idx << ", " << size << ") of "
+            << values.size())
+    {
+        BOOST_CHECK_EQUAL(index.getMin(&values[0], idx, size),
+                *std::min_element(values.begin() + idx, values.begin() + idx
+                        + size));
+        BOOST_CHECK_EQUAL(index.getMax(&values[0], idx, size),
+                *std::max_element(values.begin() + idx, values.begin() + idx
+                        + size));
+
+        double mean = scanMean(values, idx, size);
+        BOOST_CHECK_SMALL(index.getMean(idx, size) - mean, 1e-12 * mean);
+
+        // the prefix sums are relative to the mean of the series, the
+        // error is bounded by the spread of the values, not by the mean
+        double variance = scanVariance(values, idx, size);
+        BOOST_CHECK_SMALL(index.getVariance(idx, size) - variance, 1e-6
+                + 1e-6 * variance);
+    }
+}
+
+// ranges starting and ending at, next to and between the block boundaries
+std::vector<size_t> getEdges(size_t size)
+{
+    std::vector<size_t> edges;
+    for (size_t b = 0; b * B <= size; ++b)
+    {
+        for (size_t d = 0; d < 3; ++d)
+        {
+            if (b * B + d <= size)
+            {
+                edges.push_back(b * B + d);
+            }
+            if (b * B >= d)
+            {
+                edges.push_back(b * B - d);
+            }
+        }
+    }
+    edges.push_back(size);
+    std::sort(edges.begin(), edges.end());
+    edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+    return edges;
+}
+
+}
+
+BOOST_AUTO_TEST_CASE(randomRanges)
+{
+    std::vector<double> values(makeSeries(10007, 1));
+    RangeIndex index(&values[0], values.size());
+
+    for (int i = 0; i < 20000; ++i)
+    {
+        size_t idx = std::rand() % values.size();
+        size_t size = 1 + std::rand() % (values.size() - idx);
+        checkRange(index, values, idx, size);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(edgeRanges)
+{
+    // lengths shorter than a block, of whole blocks and with a partial one,
+    // of whole superblocks and with partial ones
+    size_t lengths[] = { 1, 2, B - 1, B, B + 1, 4 * B, 5 * B + 3, 97, B * B,
+            3 * B * B + 5 * B + 3 };
+    for (size_t l = 0; l < sizeof(lengths) / sizeof(lengths[0]); ++l)
+    {
+        std::vector<double> values(makeSeries(lengths[l], l + 2));
+        RangeIndex index(&values[0], values.size());
+
+        std::vector<size_t> edges(getEdges(values.size()));
+        for (size_t i = 0; i < edges.size(); ++i)
+        {
+            for (size_t j = i + 1; j < edges.size(); ++j)
+            {
+                checkRange(index, values, edges[i], edges[j] - edges[i]);
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(constantSeries)
+{
+    std::vector<double> values(3 * B + 5, 42.5);
+    RangeIndex index(&values[0], values.size());
+
+    BOOST_CHECK_EQUAL(index.getMean(3, 2 * B), 42.5);
+    BOOST_CHECK_EQUAL(index.getVariance(3, 2 * B), 0.0);
+    BOOST_CHECK_EQUAL(index.getMin(&values[0], 0, values.size()), 42.5);
+    BOOST_CHECK_EQUAL(index.getMax(&values[0], 0, values.size()), 42.5);
+}
+
+BOOST_AUTO_TEST_CASE(emptyRanges)
+{
+    std::vector<double> values(makeSeries(5 * B, 3));
+    RangeIndex index(&values[0], values.size());
+
+    size_t starts[] = { 0, B, values.size() };
+    for (size_t i = 0; i < sizeof(starts) / sizeof(starts[0]); ++i)
+    {
+        BOOST_CHECK(isNaN(index.getMean(starts[i], 0)));
+        BOOST_CHECK(isNaN(index.getVariance(starts[i], 0)));
+        BOOST_CHECK(isNaN(index.getMin(&values[0], starts[i], 0)));
+        BOOST_CHECK(isNaN(index.getMax(&values[0], starts[i], 0)));
+    }
+
+    RangeIndex empty(0, 0);
+    BOOST_CHECK(isNaN(empty.getMean(0, 0)));
+    BOOST_CHECK(isNaN(empty.getMax(0, 0, 0)));
+    BOOST_CHECK_EQUAL(empty.getMemoryUsage(), 2 * sizeof(double));
+}
+
+BOOST_AUTO_TEST_CASE(linearMemory)
+{
+    // up to a series of a month of samples every second
+    size_t sizes[] = { 1, B, 1000, 65536 * B + 7, 2600000 };
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s)
+    {
+        size_t size = sizes[s];
+        std::vector<double> values(makeSeries(size, s + 4));
+        RangeIndex index(&values[0], values.size());
+
+        size_t blocks = (size + B - 1) / B;
+        BOOST_TEST_CONTEXT("series of " << size)
+        {
+            BOOST_CHECK_LE(index.getMemoryUsage(), (2 * (size + 1) + 4
+                    * blocks) * sizeof(double));
+
+            // a superblock spans at least log2 of the blocks
+            BOOST_CHECK_GE(index.getSpan(), B);
+            BOOST_CHECK_GT(size_t(1) << index.getSpan(), blocks);
+
+            checkRange(index, values, 0, size);
+            checkRange(index, values, size / 3, size - size / 3);
+        }
+    }
+}
@@ -0,0 +1,81 @@
+/* * Copyright (c) 2010 Dariusz Gadomski <dgadomski@gmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation and/or
+ * other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CPUTOPOLOGY_H_
+#define CPUTOPOLOGY_H_
+
+#include <string>
+#include <vector>
+
+namespace prediction
+{
+
+namespace server
+{
+
+/// NUMA layout of the machine as described in /sys/devices/system/node.
+class CpuTopology
+{
+public:
+    /// Reads the topology of the online nodes which have CPUs, numbered
+    /// from 0 in the order of the kernel's numbers. Machines without NUMA
+    /// information are reported as a single node containing all online
+    /// CPUs.
+    CpuTopology();
+
+    size_t getNodeCount() const;
+    const std::vector<unsigned>& getNodeCpus(size_t node) const;
+
+    /// Returns the node the CPU belongs to (0 if unknown).
+    size_t getNode(unsigned cpu) const;
+
+    /// Parses lists in the kernel format, e.g. "0-3,8,10-11".
+    static std::vector<unsigned> parseCpuList(const std::string& list);
+
+    /// Restricts the calling thread to the given CPUs.
+    static bool pinCurrentThread(const std::vector<unsigned>& cpus);
+
+private:
+    static bool readFile(const std::string& filename, std::string& content);
+
+private:
+    std::vector<std::vector<unsigned> > _nodes;
+};
+
+inline
+size_t CpuTopology::getNodeCount() const
+{
+    return _nodes.size();
+}
+
+inline
+const std::vector<unsigned>& CpuTopology::getNodeCpus(size_t node) const
+{
+    return _nodes[node];
+}
+
+}
+}
+
+#endif /* CPUTOPOLOGY_H_ */
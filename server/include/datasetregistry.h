@@ -0,0 +1,118 @@
+/* * Copyright (c) 2010 Dariusz Gadomski <dgadomski@gmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation and/or
+ * other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DATASETREGISTRY_H_
+#define DATASETREGISTRY_H_
+
+#include <dataprovider/dataprovider.h>
+
+#include <list>
+#include <map>
+#include <string>
+#include <utility>
+
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/thread/mutex.hpp>
+
+namespace prediction
+{
+
+namespace server
+{
+
+/// Datasets served next to the default one, loaded on first use.
+/**
+ * A dataset is read from <data directory>/<id> when a request names it for
+ * the first time. Datasets are handed out as shared pointers, so a dataset
+ * used by a computation stays valid even if it is evicted meanwhile. When
+ * the loaded datasets take more memory than the budget, the least recently
+ * used ones which are not in use are dropped, both when a dataset is loaded
+ * and when the last reference to a lent one is released.
+ *
+ * A failed load is remembered for FAILURE_TIMEOUT, so that the requests
+ * for a missing dataset do not read the directory again and again.
+ */
+class DatasetRegistry
+{
+public:
+    typedef boost::shared_ptr<const models::dataprovider::DataProvider>
+            dataset_ptr;
+
+    DatasetRegistry(const std::string& dataDir, size_t memoryBudget,
+            models::dataprovider::DataProvider::Precision precision);
+    ~DatasetRegistry();
+
+    /// Returns the dataset, loading it if needed. Returns an empty pointer
+    /// if the id is not a plain file name or the file has no data.
+    dataset_ptr acquire(const std::string& id);
+
+    /// Returns the dataset only if it is loaded already.
+    dataset_ptr find(const std::string& id);
+
+    size_t getCount() const;
+    size_t getMemoryUsage() const;
+
+private:
+    typedef std::list<std::pair<std::string, dataset_ptr> > EntryList;
+    typedef std::map<std::string, EntryList::iterator> EntryIndex;
+    typedef std::map<std::string, boost::posix_time::ptime> FailureMap;
+
+    static const unsigned FAILURE_TIMEOUT = 5; // s
+
+    /// Deleter of the lent datasets, lets the registry evict the dataset
+    /// once it is not in use anymore.
+    class Releaser;
+    /// The registry as seen by the Releasers, which may outlive it.
+    struct Handle;
+
+    static bool isValidId(const std::string& id);
+    bool hasFailed(const std::string& id);
+    void addFailure(const std::string& id);
+    dataset_ptr lend(const dataset_ptr& data);
+    void release();
+    static size_t getFootprint(const models::dataprovider::DataProvider& data);
+    dataset_ptr touch(EntryIndex::iterator it);
+    void evict();
+
+private:
+    std::string _dataDir;
+    size_t _memoryBudget;
+    size_t _memoryUsage;
+    models::dataprovider::DataProvider::Precision _precision;
+    // most recently used first
+    EntryList _entries;
+    EntryIndex _index;
+    // time of the last failed load of the ids
+    FailureMap _failures;
+    // cleared by the destructor, datasets released later are just dropped
+    boost::shared_ptr<Handle> _handle;
+    mutable boost::mutex _mutex;
+};
+
+}
+}
+
+#endif /* DATASETREGISTRY_H_ */
@@ -0,0 +1,107 @@
+/* * Copyright (c) 2010 Dariusz Gadomski <dgadomski@gmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation and/or
+ * other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef MICROBATCHER_H_
+#define MICROBATCHER_H_
+
+#include <requestcoalescer.h>
+#include <workscheduler.h>
+
+#include <vector>
+
+#include <boost/asio.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <boost/function.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/thread/mutex.hpp>
+
+namespace prediction
+{
+
+namespace server
+{
+
+/// Collects requests for one model into batches.
+/**
+ * A batch is handed out when it reaches the maximal size or when the
+ * batching window of its first request expires. The window adapts to the
+ * load: it is the expected time to fill the batch at the current arrival
+ * rate (capped by the maximal window), and it drops to zero when the next
+ * request is not expected to arrive within the maximal window - so
+ * light traffic is not delayed at all.
+ */
+class MicroBatcher
+{
+public:
+    struct Entry
+    {
+        RequestKey Key;
+        TaskInfo Info;
+    };
+
+    typedef std::vector<Entry> Batch;
+    typedef boost::function<void(const Batch&)> BatchHandler;
+
+    /// onTimeout is called in the I/O thread with the batches flushed by
+    /// the timer.
+    MicroBatcher(boost::asio::io_service& io_service, size_t maxBatch,
+            const boost::posix_time::time_duration& maxWindow,
+            const BatchHandler& onTimeout);
+
+    /// Adds a request. Returns true and fills batch if the batch should be
+    /// computed right away by the caller.
+    bool add(const RequestKey& key, const TaskInfo& info, Batch& batch);
+
+    /// Returns the current batching window.
+    boost::posix_time::time_duration getWindow() const;
+
+    void handle_timeout(const boost::system::error_code& e,
+            unsigned generation);
+
+private:
+    boost::posix_time::time_duration currentWindow() const;
+    void startTimer(const boost::posix_time::time_duration& window,
+            unsigned generation);
+
+private:
+    boost::asio::io_service& _ioService;
+    boost::asio::deadline_timer _timer;
+    size_t _maxBatch;
+    boost::posix_time::time_duration _maxWindow;
+    BatchHandler _onTimeout;
+
+    Batch _pending;
+    // incremented with every handed out batch, so that a late timer does
+    // not flush a batch it was not started for
+    unsigned _generation;
+    boost::posix_time::ptime _lastArrival;
+    // moving average of the time between two requests in microseconds
+    double _meanGap;
+    mutable boost::mutex _mutex;
+};
+
+}
+}
+
+#endif /* MICROBATCHER_H_ */
@@ -25,8 +25,11 @@
 #ifndef PARSEDOPTS_H_
 #define PARSEDOPTS_H_
 
+#include <util.h>
+
 #include <iostream>
 #include <string>
+#include <vector>
 
 namespace prediction
 {
@@ -38,6 +41,26 @@ struct ParsedOptions
     unsigned ListenPort;
     std::string Algorithm;
     std::string InputFile;
+    unsigned Workers;
+    std::vector<std::string> TableFiles;
+    std::string CombinerNet;
+    bool EnsembleArima;
+    std::vector<unsigned> IoCpus;
+    std::vector<unsigned> WorkerCpus;
+    bool NumaReplicate;
+    std::string SnapshotFile;
+    unsigned CacheSize;
+    unsigned BatchSize;
+    unsigned BatchWindow;
+    bool Speculate;
+    std::string DataDir;
+    unsigned MemoryBudget;
+    bool Follow;
+    unsigned StreamCapacity;
+    bool FloatStorage;
+    bool CompressedStorage;
+    std::vector<unsigned> Resolutions;
+    std::string SeriesStoreFile;
 };
 
 }
@@ -48,6 +71,29 @@ inline std::ostream &operator<<(std::ostream &out, const prediction::server::Par
     out << "ListenPort: " << opts.ListenPort << std::endl;
     out << "Algorithm: " << opts.Algorithm << std::endl;
     out << "InputFile: " << opts.InputFile << std::endl;
+    out << "Workers: " << opts.Workers << std::endl;
+    out << "CombinerNet: " << opts.CombinerNet << std::endl;
+    out << "EnsembleArima: " << opts.EnsembleArima << std::endl;
+    debug::printSeq(out, "IoCpus: ", opts.IoCpus);
+    debug::printSeq(out, "WorkerCpus: ", opts.WorkerCpus);
+    out << "NumaReplicate: " << opts.NumaReplicate << std::endl;
+    out << "SnapshotFile: " << opts.SnapshotFile << std::endl;
+    out << "CacheSize: " << opts.CacheSize << std::endl;
+    out << "BatchSize: " << opts.BatchSize << std::endl;
+    out << "BatchWindow: " << opts.BatchWindow << std::endl;
+    out << "Speculate: " << opts.Speculate << std::endl;
+    out << "DataDir: " << opts.DataDir << std::endl;
+    out << "MemoryBudget: " << opts.MemoryBudget << std::endl;
+    out << "Follow: " << opts.Follow << std::endl;
+    out << "StreamCapacity: " << opts.StreamCapacity << std::endl;
+    out << "FloatStorage: " << opts.FloatStorage << std::endl;
+    out << "CompressedStorage: " << opts.CompressedStorage << std::endl;
+    debug::printSeq(out, "Resolutions: ", opts.Resolutions);
+    out << "SeriesStoreFile: " << opts.SeriesStoreFile << std::endl;
+    for (size_t i = 0; i < opts.TableFiles.size(); ++i)
+    {
+        out << "TableFile: " << opts.TableFiles[i] << std::endl;
+    }
     out << std::endl;
     return out;
 }
@@ -25,14 +25,28 @@
 #ifndef PREDICTIONCLIENT_H_
 #define PREDICTIONCLIENT_H_
 
+#include <cputopology.h>
+#include <datasetregistry.h>
+#include <microbatcher.h>
 #include <parsedopts.h>
+#include <requestcoalescer.h>
+#include <resultcache.h>
+#include <session.h>
+#include <workscheduler.h>
 
+#include <dataprovider/aggregationpyramid.h>
 #include <dataprovider/dataprovider.h>
+#include <dataprovider/predictiontable.h>
+#include <dataprovider/seriesstore.h>
+#include <dataprovider/streamingdataprovider.h>
 #include <modelbase.h>
 
 #include <boost/asio.hpp>
 #include <boost/bind.hpp>
+#include <boost/thread.hpp>
+#include <boost/thread/tss.hpp>
 #include <iostream>
+#include <map>
 #include <vector>
 
 #include <comm/connection.h> // Must come before boost/serialization headers.
@@ -51,47 +65,166 @@ namespace server
 class PredictionServer
 {
 public:
+    /// Algorithm name of the server-side ensemble of models.
+    static const char* ENSEMBLE;
+
     /// Constructor starts the asynchronous connect operation.
     PredictionServer(boost::asio::io_service& io_service,
             const ParsedOptions& opts);
 
-    virtual ~PredictionServer()
-    {
-        std::cout << "~PredictionClient()" << std::endl;
-    }
-
-
+    virtual ~PredictionServer();
 
     /// Handle completion of a accept operation.
     void handle_accept(const boost::system::error_code& e,
-            comm::connection_ptr conn);
+            session_ptr session);
 
     /// Handle completion of a read operation.
     void handle_read(const boost::system::error_code& e,
-            comm::connection_ptr conn);
+            session_ptr session);
 
     void handle_write(const boost::system::error_code& e,
-            comm::connection_ptr conn);
+            session_ptr session);
+
+    /// Handle SIGINT/SIGTERM - saves the snapshot and stops the server.
+    void handle_signal(const boost::system::error_code& e);
+
+    /// Handle completion of a model computation (called in the I/O thread).
+    void handle_computed(const RequestKey& key, double prediction,
+            const std::vector<double>& components);
 
 private:
+    /// Ensemble prediction in progress - the component models run in
+    /// parallel on the same input window.
+    struct EnsembleJob
+    {
+        EnsembleJob(const RequestKey& key, size_t numComponents) :
+            Key(key), Components(numComponents), Pending(numComponents)
+        {
+        }
+
+        RequestKey Key;
+        DatasetRegistry::dataset_ptr Data;
+        // window of Data, which the job keeps alive
+        models::DataView Input;
+        std::vector<double> Components;
+        size_t Pending;
+        boost::mutex Mutex;
+    };
+
+    typedef std::map<std::string, boost::shared_ptr<models::AbstractModel> >
+            ModelMap;
+
+    /// State owned by a single worker thread.
+    struct WorkerContext
+    {
+        WorkerContext() :
+            Node(0)
+        {
+        }
+
+        ModelMap Models;
+        // replica of the dataset allocated on the worker's NUMA node
+        boost::shared_ptr<models::dataprovider::DataProvider> LocalData;
+        size_t Node;
+        // working memory of the models, reset after every task
+        models::Arena Arena;
+    };
+
+    typedef DatasetRegistry::dataset_ptr dataset_ptr;
+
+    static const char* COMBINER;
+
+    void startAccept();
+    void loadState();
+    void startStream();
+    void loadNetDefinition(const std::string& algorithm,
+            const std::string& filename);
+    bool restoreSnapshot();
+    void saveSnapshot();
+    void loadPredictionTables();
+    void buildPyramid();
+    void loadSeriesStore();
+    bool lookupPredictionTables(const RequestKey& key, double& prediction) const;
+    void sendResult(session_ptr session, double prediction,
+            const std::vector<double>& components);
     void interpretInputMessage(const comm::protocol::Message& msg);
+    void speculateNext(session_ptr session, const RequestKey& key);
+    void computePrediction(const RequestKey& key, const TaskInfo& info,
+            session_ptr session);
+    void computeComponent(boost::shared_ptr<EnsembleJob> job, size_t idx);
+    void computeBatch(const MicroBatcher::Batch& batch);
+    void postBatch(const MicroBatcher::Batch& batch);
     double getPrediction(size_t offset, size_t length, size_t horizon,
             size_t progress);
-    void createPredictionModel(const std::string& algorithm);
+    models::AbstractModel* getPredictionModel(const std::string& algorithm,
+            const models::dataprovider::DataProvider& data);
+    models::AbstractModel* getSlidingModel(const RequestKey& key,
+            session_ptr session,
+            const models::dataprovider::DataProvider& data);
+    models::AbstractModel* createModel(const std::string& algorithm,
+            const models::dataprovider::DataProvider& data);
+    void runWorker(unsigned idx);
+    WorkerContext& getWorkerContext();
+    boost::shared_ptr<models::dataprovider::DataProvider> getNodeData(
+            size_t node);
+    dataset_ptr getDataset(const std::string& id);
+    /// Returns the series of the request holding at least the values
+    /// [begin, end), which is a snapshot of the window for the followed
+    /// input file and a level of the pyramid for a coarser resolution.
+    dataset_ptr getDataset(const RequestKey& key, size_t begin, size_t end);
+    /// Returns the level of the pyramid the request is computed on, an empty
+    /// pointer if there is no such one.
+    dataset_ptr getLevel(const RequestKey& key) const;
+    /// Returns the series of the series store the request is computed on,
+    /// an empty pointer if there is no such one.
+    dataset_ptr getStoredSeries(const RequestKey& key) const;
+    void resolveLatest(RequestKey& key) const;
+    const models::dataprovider::DataProvider& getDataProvider() const;
 
 private:
+    boost::asio::io_service& _ioService;
     boost::asio::ip::tcp::acceptor _acceptor;
-    comm::protocol::Message _inBuffer;
-    comm::protocol::Message _outBuffer;
+    boost::asio::signal_set _signals;
     std::string _algorithm;
     bool _stopFlag;
     bool _predictionStarted;
     boost::shared_ptr<models::dataprovider::DataProvider> _dataProvider;
-    boost::shared_ptr<models::AbstractModel> _predictionModel;
+    // the followed input file, serves the default dataset instead of
+    // _dataProvider (--follow)
+    boost::shared_ptr<models::dataprovider::StreamingDataProvider> _stream;
+    // coarser resolutions of the default dataset (--resolutions)
+    boost::shared_ptr<const models::dataprovider::AggregationPyramid>
+            _pyramid;
+    // many series addressed by their ids (--series-store)
+    boost::shared_ptr<const models::dataprovider::SeriesStore> _seriesStore;
     const ParsedOptions& _opts;
 
-    /// The data received from the server.
-    //  std::vector<stock> stocks_;
+    std::vector<std::string> _componentAlgorithms;
+
+    // contents of the neural net files, keyed by the algorithm name
+    std::map<std::string, std::string> _netDefinitions;
+
+    // model computations are run by the worker threads, each of them owns
+    // separate instances of the prediction models
+    WorkScheduler _scheduler;
+    MicroBatcher _batcher;
+    boost::thread_group _workers;
+    boost::thread_specific_ptr<WorkerContext> _workerContexts;
+
+    CpuTopology _topology;
+    std::vector<boost::shared_ptr<models::dataprovider::DataProvider> >
+            _nodeData;
+    boost::mutex _nodeDataMutex;
+
+    // datasets named by the requests, next to the default one
+    DatasetRegistry _datasets;
+
+    std::vector<boost::shared_ptr<models::dataprovider::PredictionTable> >
+            _predictionTables;
+
+    ResultCache _resultCache;
+    RequestCoalescer _coalescer;
+    unsigned _sessionCount;
 };
 
 }
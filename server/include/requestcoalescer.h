@@ -0,0 +1,139 @@
+/* * Copyright (c) 2010 Dariusz Gadomski <dgadomski@gmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation and/or
+ * other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef REQUESTCOALESCER_H_
+#define REQUESTCOALESCER_H_
+
+#include <session.h>
+#include <workscheduler.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <boost/thread/locks.hpp>
+#include <boost/thread/mutex.hpp>
+
+namespace prediction
+{
+
+namespace server
+{
+
+/// Identifies a prediction request. Two requests with equal keys always
+/// produce the same result.
+/**
+ * The priority class is not a part of the key, as it does not change the
+ * result: an urgent request joins a computation queued as bulk work (e.g.
+ * a speculative one) and raises its class instead of computing the window
+ * again.
+ */
+struct RequestKey
+{
+    RequestKey(size_t offset = 0, size_t length = 0, size_t horizon = 0,
+            unsigned priority = comm::protocol::Normal,
+            const std::string& datasetId = std::string()) :
+        DataOffset(offset), DataLength(length), Horizon(horizon),
+                Priority(priority), DatasetId(datasetId), Resolution(1),
+                Aggregation(0)
+    {
+    }
+
+    bool operator<(const RequestKey& other) const;
+
+    /// Returns a name of the series the request is computed on, the same
+    /// for all the requests reading the same values.
+    std::string getSeriesId() const;
+
+    size_t DataOffset;
+    size_t DataLength;
+    size_t Horizon;
+    unsigned Priority;
+    // empty for the default dataset of the server
+    std::string DatasetId;
+    // level of the aggregation pyramid (1 - the dataset itself)
+    unsigned Resolution;
+    unsigned Aggregation;
+    // series of the series store, used instead of the dataset if not empty
+    std::string SeriesId;
+};
+
+/// Deduplicates identical requests which are being computed at the same time.
+/**
+ * The first session asking for a given key becomes the leader and starts the
+ * computation. Sessions asking for the same key before the computation is
+ * finished only wait for its result, which is then sent to all of them.
+ *
+ * Every computation remembers the most urgent class of its sessions and
+ * its task in the WorkScheduler, so that the task can be raised when a
+ * more urgent session joins.
+ */
+class RequestCoalescer
+{
+public:
+    RequestCoalescer();
+
+    /// Registers the session as waiting for the key. Returns true if there
+    /// was no computation in flight and the caller has to start one.
+    bool join(const RequestKey& key, session_ptr session);
+
+    /// Records the scheduler task computing the key.
+    void setTask(const RequestKey& key, WorkScheduler::TaskId task);
+
+    /// Records the class of the key for its computation. Returns true and
+    /// the task of the computation if the class is more urgent than the
+    /// ones of all the sessions so far, the task then has to be raised.
+    bool raise(const RequestKey& key, WorkScheduler::TaskId& task);
+
+    /// Finishes the computation for the key and returns all waiting sessions.
+    std::vector<session_ptr> complete(const RequestKey& key);
+
+    unsigned long getCoalescedCount() const;
+
+private:
+    struct Flight
+    {
+        Flight() :
+            Priority(comm::protocol::NumPriorities), HasTask(false), Task(0)
+        {
+        }
+
+        std::vector<session_ptr> Waiters;
+        // most urgent class of the waiters
+        unsigned Priority;
+        bool HasTask;
+        WorkScheduler::TaskId Task;
+    };
+
+    typedef std::map<RequestKey, Flight> FlightMap;
+
+    FlightMap _flights;
+    unsigned long _coalescedCount;
+    mutable boost::mutex _mutex;
+};
+
+}
+}
+
+#endif /* REQUESTCOALESCER_H_ */
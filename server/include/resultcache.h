@@ -0,0 +1,94 @@
+/* * Copyright (c) 2010 Dariusz Gadomski <dgadomski@gmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation and/or
+ * other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef RESULTCACHE_H_
+#define RESULTCACHE_H_
+
+#include <requestcoalescer.h>
+
+#include <list>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include <boost/thread/locks.hpp>
+#include <boost/thread/mutex.hpp>
+
+namespace prediction
+{
+
+namespace server
+{
+
+/// Result of a finished computation.
+struct CachedResult
+{
+    CachedResult() :
+        Prediction(0.0)
+    {
+    }
+
+    double Prediction;
+    std::vector<double> Components;
+};
+
+/// Bounded cache of computed predictions with least-recently-used eviction.
+/**
+ * The priority class of the request is not a part of the cached key -
+ * the result does not depend on it.
+ */
+class ResultCache
+{
+public:
+    typedef std::pair<RequestKey, CachedResult> Entry;
+
+    explicit ResultCache(size_t capacity);
+
+    bool lookup(const RequestKey& key, CachedResult& result);
+    void insert(const RequestKey& key, const CachedResult& result);
+
+    /// Returns the cached entries from the least to the most recently used.
+    std::vector<Entry> getEntries() const;
+
+    size_t getCapacity() const;
+    size_t getSize() const;
+
+private:
+    typedef std::list<Entry> EntryList;
+    typedef std::map<RequestKey, EntryList::iterator> EntryIndex;
+
+    static RequestKey normalize(const RequestKey& key);
+
+private:
+    // most recently used entries are at the front
+    EntryList _entries;
+    EntryIndex _index;
+    size_t _capacity;
+    mutable boost::mutex _mutex;
+};
+
+}
+}
+
+#endif /* RESULTCACHE_H_ */
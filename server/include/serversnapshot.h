@@ -0,0 +1,162 @@
+/* * Copyright (c) 2010 Dariusz Gadomski <dgadomski@gmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation and/or
+ * other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SERVERSNAPSHOT_H_
+#define SERVERSNAPSHOT_H_
+
+#include <requestcoalescer.h>
+#include <resultcache.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <boost/cstdint.hpp>
+#include <boost/serialization/map.hpp>
+#include <boost/serialization/string.hpp>
+#include <boost/serialization/utility.hpp>
+#include <boost/serialization/vector.hpp>
+#include <boost/serialization/version.hpp>
+
+namespace prediction
+{
+
+namespace server
+{
+
+/// State of the server which is expensive to rebuild on startup.
+/**
+ * Stored as a single binary archive: the parsed dataset (encoded if it is
+ * kept compressed, a mapped series file is mapped again instead), the
+ * definitions of the neural nets (learning.net and the combiner) and the
+ * contents of the result cache. ARIMA is fitted by R for every window and has no state of
+ * its own - its results are kept in the result cache.
+ *
+ * The size and the modification time of the input file are kept as well,
+ * a snapshot of a file which changed since is not restored.
+ */
+struct ServerSnapshot
+{
+    ServerSnapshot();
+
+    std::string Algorithm;
+    std::string InputFile;
+    // set if InputFile is a series file, which is not saved
+    bool Mapped;
+    boost::uint64_t InputSize;
+    boost::int64_t InputTime;
+    std::vector<double> Data;
+    // set instead of Data for compressed values, see CompressedSeries
+    std::vector<boost::uint64_t> CompressedBits;
+    std::vector<boost::uint64_t> CompressedBlocks;
+    boost::uint64_t CompressedCount;
+    std::map<std::string, std::string> NetDefinitions;
+    std::vector<ResultCache::Entry> Results;
+
+    bool save(const std::string& filename) const;
+    bool load(const std::string& filename);
+
+    /// Records the size and the modification time of InputFile.
+    void stampInput();
+    /// Returns true if InputFile still has the recorded size and
+    /// modification time.
+    bool isInputCurrent() const;
+
+    template<typename Archive>
+    void serialize(Archive& ar, const unsigned int version)
+    {
+        ar & Algorithm;
+        ar & InputFile;
+        // the input of an older snapshot cannot be checked, it is left
+        // unstamped and never current
+        if (version > 0)
+        {
+            ar & InputSize;
+            ar & InputTime;
+        }
+        ar & Data;
+        if (version > 1)
+        {
+            ar & CompressedBits;
+            ar & CompressedBlocks;
+            ar & CompressedCount;
+        }
+        if (version > 2)
+        {
+            ar & Mapped;
+        }
+        ar & NetDefinitions;
+        ar & Results;
+    }
+};
+
+}
+}
+
+namespace boost
+{
+namespace serialization
+{
+
+template<typename Archive>
+void serialize(Archive& ar, prediction::server::RequestKey& key,
+        const unsigned int version)
+{
+    ar & key.DataOffset;
+    ar & key.DataLength;
+    ar & key.Horizon;
+    ar & key.Priority;
+
+    if (version > 0)
+    {
+        ar & key.DatasetId;
+    }
+
+    if (version > 1)
+    {
+        ar & key.Resolution;
+        ar & key.Aggregation;
+    }
+
+    if (version > 2)
+    {
+        ar & key.SeriesId;
+    }
+}
+
+template<typename Archive>
+void serialize(Archive& ar, prediction::server::CachedResult& result,
+        const unsigned int version)
+{
+    ar & result.Prediction;
+    ar & result.Components;
+}
+
+}
+}
+
+BOOST_CLASS_VERSION(prediction::server::ServerSnapshot, 3)
+BOOST_CLASS_VERSION(prediction::server::RequestKey, 3)
+
+#endif /* SERVERSNAPSHOT_H_ */
@@ -0,0 +1,103 @@
+/* * Copyright (c) 2010 Dariusz Gadomski <dgadomski@gmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation and/or
+ * other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SESSION_H_
+#define SESSION_H_
+
+#include <boost/asio.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include <comm/connection.h> // Must come before boost/serialization headers.
+#include <comm/protocol.h>
+#include <modelbase.h>
+
+#include <cstddef>
+#include <string>
+
+namespace prediction
+{
+
+namespace server
+{
+
+/// State of a single client connection.
+/**
+ * Every connection gets its own message buffers, so that requests coming
+ * from different clients do not overwrite each other while the model
+ * computation runs on a worker thread.
+ */
+class Session
+{
+public:
+    Session(boost::asio::io_service& io_service, unsigned id) :
+        WindowOffset(0), WindowLength(0), LastOffset(0), LastLength(0),
+                LastHorizon(0), _connection(new comm::connection(
+                io_service)), _id(id)
+    {
+    }
+
+    comm::connection_ptr connection() const
+    {
+        return _connection;
+    }
+
+    unsigned getId() const
+    {
+        return _id;
+    }
+
+    comm::protocol::Message InBuffer;
+    comm::protocol::Message OutBuffer;
+
+    /// Model following the input window of the session's last request.
+    /**
+     * Only used for algorithms which support sliding input. A client sends
+     * its next request only after the previous answer arrived, so the
+     * model is never used by two workers at the same time.
+     */
+    boost::shared_ptr<models::AbstractModel> SlidingModel;
+    size_t WindowOffset;
+    size_t WindowLength;
+    // RequestKey::getSeriesId() of the window
+    std::string WindowDataset;
+
+    /// Window of the last request received (LastLength is 0 before the
+    /// first one), used to guess the next request.
+    size_t LastOffset;
+    size_t LastLength;
+    size_t LastHorizon;
+    // RequestKey::getSeriesId() of the window
+    std::string LastDataset;
+
+private:
+    comm::connection_ptr _connection;
+    unsigned _id;
+};
+
+typedef boost::shared_ptr<Session> session_ptr;
+
+}
+}
+
+#endif /* SESSION_H_ */
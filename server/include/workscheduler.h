@@ -0,0 +1,130 @@
+/* * Copyright (c) 2010 Dariusz Gadomski <dgadomski@gmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation and/or
+ * other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef WORKSCHEDULER_H_
+#define WORKSCHEDULER_H_
+
+#include <comm/protocol.h>
+
+#include <deque>
+#include <map>
+#include <vector>
+
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <boost/function.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/thread/mutex.hpp>
+
+namespace prediction
+{
+
+namespace server
+{
+
+/// Scheduling attributes of a task.
+struct TaskInfo
+{
+    TaskInfo() :
+        Priority(comm::protocol::Normal), SessionId(0)
+    {
+    }
+
+    unsigned Priority;
+    unsigned SessionId;
+    // not_a_date_time if the task has no deadline
+    boost::posix_time::ptime Deadline;
+};
+
+/// Queue of model computations shared by the worker threads.
+/**
+ * Tasks are scheduled strictly by priority class, so bulk work (backfills,
+ * backtests) only runs when no realtime or normal work is waiting. Inside
+ * a class every session has its own FIFO queue. If any of the queued tasks
+ * has a deadline, the one with the earliest deadline runs first (EDF),
+ * otherwise the sessions are served round-robin.
+ *
+ * A queued task may be moved to a more urgent class, e.g. when a realtime
+ * request joins a computation queued as bulk work.
+ */
+class WorkScheduler
+{
+public:
+    typedef boost::function<void()> Task;
+    typedef unsigned long TaskId;
+
+    WorkScheduler();
+
+    /// Queues the task, the returned id is unique for the scheduler.
+    TaskId post(const Task& task, const TaskInfo& info);
+
+    /// Moves the task to the given class if it is still queued in a less
+    /// urgent one. Returns false if the task is running, done or already
+    /// urgent enough.
+    bool raise(TaskId id, unsigned priority);
+
+    /// Runs tasks in the calling thread until stop() is called. onTaskDone
+    /// is called after every task.
+    void run(const Task& onTaskDone = Task());
+
+    void stop();
+
+    size_t getPendingCount() const;
+
+private:
+    struct Entry
+    {
+        Task Function;
+        boost::posix_time::ptime Deadline;
+        TaskId Id;
+    };
+
+    struct PriorityClass
+    {
+        PriorityClass() :
+            Pending(0), NextSession(0)
+        {
+        }
+
+        std::map<unsigned, std::deque<Entry> > Sessions;
+        size_t Pending;
+        // round-robin position (id of the session to be served next)
+        unsigned NextSession;
+    };
+
+    bool pop(Task& task);
+
+private:
+    std::vector<PriorityClass> _classes;
+    bool _stopped;
+    size_t _pending;
+    TaskId _nextId;
+    mutable boost::mutex _mutex;
+    boost::condition_variable _taskAvailable;
+};
+
+}
+}
+
+#endif /* WORKSCHEDULER_H_ */
@@ -4,14 +4,23 @@ PROFILE=Debug
 EXEC=${PROFILE}/server
 ALGORITHMS="chaos grey neural"
 INPUT_FILE=output-1s.txt
+SERIES_FILE=${INPUT_FILE%.txt}.bin
+CONVERT=../tools/${PROFILE}/convertdata
 PORT=4421
 DEBUG_LEVEL=2
 export LD_LIBRARY_PATH=../models/${PROFILE}:${LD_LIBRARY_PATH}
 
 killall server -q
 
+# the binary series file is mapped by the servers instead of being parsed
+# by each of them
+if [ ! -f ${SERIES_FILE} -o ${INPUT_FILE} -nt ${SERIES_FILE} ]
+then
+    ${CONVERT} -i ${INPUT_FILE} -o ${SERIES_FILE} -d ${DEBUG_LEVEL} || exit 1
+fi
+
 for alg in ${ALGORITHMS}
 do
-    ${EXEC} -a ${alg} -i ${INPUT_FILE} -l ${PORT} -d ${DEBUG_LEVEL} &
+    ${EXEC} -a ${alg} -i ${SERIES_FILE} -l ${PORT} -d ${DEBUG_LEVEL} &
     (( PORT= $PORT + 1 ))
 done
@@ -0,0 +1,193 @@
+//
+// Copyright (c) 2010 Dariusz Gadomski <dgadomski@gmail.com>
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <cputopology.h>
+
+#include <util.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+#include <boost/lexical_cast.hpp>
+
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+
+namespace prediction
+{
+
+namespace server
+{
+
+using namespace debug;
+
+const char* SYS_NODE_PATH = "/sys/devices/system/node/node";
+const char* SYS_ONLINE_NODES = "/sys/devices/system/node/online";
+const char* SYS_ONLINE_CPUS = "/sys/devices/system/cpu/online";
+
+CpuTopology::CpuTopology()
+{
+    // the online nodes need not be numbered contiguously
+    std::string content;
+    std::vector<unsigned> online;
+    if (readFile(SYS_ONLINE_NODES, content))
+    {
+        online = parseCpuList(content);
+    }
+
+    // numbers of the nodes in _nodes as the kernel knows them
+    std::vector<unsigned> ids;
+    for (size_t i = 0; i < online.size(); ++i)
+    {
+        std::string filename = SYS_NODE_PATH
+                + boost::lexical_cast<std::string>(online[i]) + "/cpulist";
+        if (!readFile(filename, content))
+        {
+            continue;
+        }
+        // nodes with memory only have no CPU to run a worker on
+        std::vector<unsigned> cpus(parseCpuList(content));
+        if (!cpus.empty())
+        {
+            _nodes.push_back(cpus);
+            ids.push_back(online[i]);
+        }
+    }
+
+    if (_nodes.empty())
+    {
+        std::vector<unsigned> cpus;
+        if (readFile(SYS_ONLINE_CPUS, content))
+        {
+            cpus = parseCpuList(content);
+        }
+        if (cpus.empty())
+        {
+            // no sysfs, the CPUs are assumed to be numbered from 0
+            long count = sysconf(_SC_NPROCESSORS_ONLN);
+            for (long cpu = 0; cpu < std::max(count, 1L); ++cpu)
+            {
+                cpus.push_back(cpu);
+            }
+        }
+        _nodes.push_back(cpus);
+        ids.push_back(0);
+    }
+
+    for (size_t i = 0; i < _nodes.size(); ++i)
+    {
+        std::ostringstream oss;
+        oss << "NUMA node " << ids[i] << " CPUs: ";
+        printSeq(oss.str(), _nodes[i], debug::Informational);
+    }
+}
+
+size_t CpuTopology::getNode(unsigned cpu) const
+{
+    for (size_t i = 0; i < _nodes.size(); ++i)
+    {
+        if (std::find(_nodes[i].begin(), _nodes[i].end(), cpu)
+                != _nodes[i].end())
+        {
+            return i;
+        }
+    }
+    return 0;
+}
+
+std::vector<unsigned> CpuTopology::parseCpuList(const std::string& list)
+{
+    std::vector<unsigned> cpus;
+    std::istringstream iss(list);
+    std::string range;
+
+    while (std::getline(iss, range, ','))
+    {
+        size_t dash = range.find('-');
+        unsigned first = std::strtoul(range.c_str(), 0, 10);
+        unsigned last = first;
+        if (dash != std::string::npos)
+        {
+            last = std::strtoul(range.c_str() + dash + 1, 0, 10);
+        }
+
+        if (range.find_first_of("0123456789") == std::string::npos)
+        {
+            continue;
+        }
+
+        for (unsigned cpu = first; cpu <= last; ++cpu)
+        {
+            cpus.push_back(cpu);
+        }
+    }
+
+    return cpus;
+}
+
+bool CpuTopology::pinCurrentThread(const std::vector<unsigned>& cpus)
+{
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    size_t count = 0;
+    for (size_t i = 0; i < cpus.size(); ++i)
+    {
+        if (cpus[i] < CPU_SETSIZE)
+        {
+            CPU_SET(cpus[i], &set);
+            ++count;
+        }
+    }
+
+    if (count == 0)
+    {
+        printSeq("No valid CPU to pin thread to: ", cpus, debug::High);
+        return false;
+    }
+
+    if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0)
+    {
+        printSeq("Cannot pin thread to CPUs: ", cpus, debug::High);
+        return false;
+    }
+    return true;
+}
+
+bool CpuTopology::readFile(const std::string& filename, std::string& content)
+{
+    std::ifstream in(filename.c_str());
+    if (!in)
+    {
+        return false;
+    }
+    std::getline(in, content);
+    return true;
+}
+
+}
+}
@@ -0,0 +1,268 @@
+//
+// Copyright (c) 2010 Dariusz Gadomski <dgadomski@gmail.com>
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <datasetregistry.h>
+
+#include <util.h>
+
+namespace prediction
+{
+
+namespace server
+{
+
+using namespace models::dataprovider;
+using namespace debug;
+
+const unsigned DatasetRegistry::FAILURE_TIMEOUT;
+
+struct DatasetRegistry::Handle
+{
+    explicit Handle(DatasetRegistry* registry) :
+        Registry(registry)
+    {
+    }
+
+    // held while the registry is used, so that it is not destroyed meanwhile
+    boost::mutex Mutex;
+    DatasetRegistry* Registry;
+};
+
+class DatasetRegistry::Releaser
+{
+public:
+    Releaser(const dataset_ptr& data, const boost::shared_ptr<Handle>& handle) :
+        _data(data), _handle(handle)
+    {
+    }
+
+    void operator()(const DataProvider*)
+    {
+        // the reference is dropped first, so the dataset counts as unused
+        _data.reset();
+        boost::lock_guard<boost::mutex> lock(_handle->Mutex);
+        if (_handle->Registry)
+        {
+            _handle->Registry->release();
+        }
+    }
+
+private:
+    dataset_ptr _data;
+    boost::shared_ptr<Handle> _handle;
+};
+
+DatasetRegistry::DatasetRegistry(const std::string& dataDir,
+        size_t memoryBudget, DataProvider::Precision precision) :
+    _dataDir(dataDir), _memoryBudget(memoryBudget), _memoryUsage(0),
+            _precision(precision), _handle(new Handle(this))
+{
+}
+
+DatasetRegistry::~DatasetRegistry()
+{
+    // waits for the releases in progress
+    boost::lock_guard<boost::mutex> lock(_handle->Mutex);
+    _handle->Registry = 0;
+}
+
+DatasetRegistry::dataset_ptr DatasetRegistry::acquire(const std::string& id)
+{
+    if (!isValidId(id))
+    {
+        dbg(debug::High) << "Invalid dataset id: " << id << std::endl;
+        return dataset_ptr();
+    }
+
+    {
+        boost::lock_guard<boost::mutex> lock(_mutex);
+        EntryIndex::iterator it = _index.find(id);
+        if (it != _index.end())
+        {
+            return touch(it);
+        }
+    }
+
+    if (hasFailed(id))
+    {
+        return dataset_ptr();
+    }
+
+    // the file is parsed without holding the lock, so that requests for
+    // the loaded datasets are not blocked - if two threads load the same
+    // dataset at once, the second copy is dropped
+    dataset_ptr data(new DataProvider(_dataDir + "/" + id, _precision));
+    if (data->getDataSize() == 0)
+    {
+        dbg(debug::High) << "No data in dataset " << id << std::endl;
+        addFailure(id);
+        return dataset_ptr();
+    }
+
+    boost::lock_guard<boost::mutex> lock(_mutex);
+    EntryIndex::iterator it = _index.find(id);
+    if (it != _index.end())
+    {
+        return touch(it);
+    }
+
+    _entries.push_front(std::make_pair(id, data));
+    _index[id] = _entries.begin();
+    _memoryUsage += getFootprint(*data);
+    _failures.erase(id);
+
+    dbg(debug::Informational) << "Loaded dataset " << id << " ("
+            << data->getDataSize() << " items, compression ratio "
+            << data->getCompressionRatio() << ", " << _memoryUsage
+            << " bytes in use)" << std::endl;
+
+    // lent before the eviction, so it is not evicted right away
+    dataset_ptr lent(lend(data));
+    evict();
+    return lent;
+}
+
+DatasetRegistry::dataset_ptr DatasetRegistry::find(const std::string& id)
+{
+    boost::lock_guard<boost::mutex> lock(_mutex);
+
+    EntryIndex::iterator it = _index.find(id);
+    if (it == _index.end())
+    {
+        return dataset_ptr();
+    }
+    return touch(it);
+}
+
+size_t DatasetRegistry::getCount() const
+{
+    boost::lock_guard<boost::mutex> lock(_mutex);
+    return _entries.size();
+}
+
+size_t DatasetRegistry::getMemoryUsage() const
+{
+    boost::lock_guard<boost::mutex> lock(_mutex);
+    return _memoryUsage;
+}
+
+bool DatasetRegistry::isValidId(const std::string& id)
+{
+    if (id.empty() || id[0] == '.')
+    {
+        return false;
+    }
+    return id.find('/') == std::string::npos;
+}
+
+size_t DatasetRegistry::getFootprint(const DataProvider& data)
+{
+    return data.getMemoryUsage();
+}
+
+bool DatasetRegistry::hasFailed(const std::string& id)
+{
+    boost::lock_guard<boost::mutex> lock(_mutex);
+
+    FailureMap::iterator it = _failures.find(id);
+    if (it == _failures.end())
+    {
+        return false;
+    }
+    if (boost::posix_time::microsec_clock::universal_time() - it->second
+            < boost::posix_time::seconds(FAILURE_TIMEOUT))
+    {
+        return true;
+    }
+    _failures.erase(it);
+    return false;
+}
+
+void DatasetRegistry::addFailure(const std::string& id)
+{
+    boost::posix_time::ptime now =
+            boost::posix_time::microsec_clock::universal_time();
+
+    boost::lock_guard<boost::mutex> lock(_mutex);
+
+    // the expired failures are dropped, so that requests for many bogus
+    // ids do not fill the memory
+    for (FailureMap::iterator it = _failures.begin(); it != _failures.end();)
+    {
+        if (now - it->second >= boost::posix_time::seconds(FAILURE_TIMEOUT))
+        {
+            _failures.erase(it++);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+    _failures[id] = now;
+}
+
+DatasetRegistry::dataset_ptr DatasetRegistry::lend(const dataset_ptr& data)
+{
+    // every lent pointer holds a reference to the dataset, which the
+    // eviction counts
+    return dataset_ptr(data.get(), Releaser(data, _handle));
+}
+
+void DatasetRegistry::release()
+{
+    boost::lock_guard<boost::mutex> lock(_mutex);
+    evict();
+}
+
+DatasetRegistry::dataset_ptr DatasetRegistry::touch(EntryIndex::iterator it)
+{
+    _entries.splice(_entries.begin(), _entries, it->second);
+    return lend(it->second->second);
+}
+
+void DatasetRegistry::evict()
+{
+    EntryList::iterator it = _entries.end();
+    while (_memoryUsage > _memoryBudget && it != _entries.begin())
+    {
+        --it;
+
+        // the registry holds the only reference to a dataset not in use
+        if (it->second.use_count() > 1)
+        {
+            continue;
+        }
+
+        dbg(debug::Informational) << "Evicting dataset " << it->first
+                << std::endl;
+
+        _memoryUsage -= getFootprint(*it->second);
+        _index.erase(it->first);
+        it = _entries.erase(it);
+    }
+}
+
+}
+}
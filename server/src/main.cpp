@@ -24,6 +24,7 @@
 //
 
 #include <predictionserver.h>
+#include <cputopology.h>
 #include <parsedopts.h>
 
 #include <util.h>
@@ -41,7 +42,7 @@ const unsigned DEFAULT_SERVER_PORT = 4421;
 const std::string DEFAULT_SERVER_ADDRESS = "localhost";
 
 const char* ALLOWED_ALGORITHMS[] =
-{ "arima", "chaos", "grey", "neural" };
+{ "arima", "chaos", "grey", "neural", "ensemble" };
 
 ParsedOptions parseOptions(int argc, char *argv[]);
 
@@ -72,10 +73,83 @@ ParsedOptions parseOptions(int argc, char *argv[])
                 "(or service name e.g. http)")
 
     ("algorithm,a", po::value<std::string>(),
-            "set prediction algorithm: arima, grey, neural")
+            "set prediction algorithm: arima, chaos, grey, neural, ensemble")
 
     ("input-file,i", po::value<std::string>(), "set path to the input file")
 
+    ("workers,w", po::value<unsigned>()->default_value(1),
+            "set number of threads running the prediction model")
+
+    ("table-file,t", po::value<std::vector<std::string> >(),
+            "answer requests from a precomputed prediction table "
+                "(may be given multiple times)")
+
+    ("combiner-net,c", po::value<std::string>(),
+            "set file to read the neural net combining the models from "
+                "(only valid if algorithm=ensemble)")
+
+    ("ensemble-arima", "include ARIMA in the ensemble of models")
+
+    ("io-cpus", po::value<std::string>(),
+            "pin the I/O thread to the CPUs, e.g. 0 or 0-1")
+
+    ("worker-cpus", po::value<std::string>(),
+            "pin the worker threads (one CPU per worker, round-robin), "
+                "e.g. 2-7,10-15")
+
+    ("numa-replicate",
+            "keep a copy of the dataset on the NUMA node of every worker")
+
+    ("snapshot-file,S", po::value<std::string>(),
+            "restore the server state from the file on startup (if present) "
+                "and save it there on SIGINT/SIGTERM")
+
+    ("cache-size", po::value<unsigned>()->default_value(0),
+            "set number of computed predictions kept in memory (0 - off)")
+
+    ("data-dir", po::value<std::string>()->default_value("."),
+            "set directory of the datasets requested by name")
+
+    ("memory-budget", po::value<unsigned>()->default_value(1024),
+            "set memory in MB for the datasets requested by name, the least "
+            "recently used ones are unloaded above it")
+
+    ("follow",
+            "keep reading the values appended to the input file (- for the "
+                "standard input) and serve the newest ones")
+
+    ("stream-capacity", po::value<unsigned>()->default_value(1 << 20),
+            "set number of the newest values kept with --follow")
+
+    ("resolutions", po::value<std::vector<unsigned> >()->multitoken(),
+            "aggregate the input file by the given numbers of samples on "
+            "load, requests may then ask for these resolutions")
+
+    ("series-store", po::value<std::string>(),
+            "serve the series of the file (a line per time step with a value "
+            "of every series, optionally preceded by \"# <id> <id> ...\") "
+            "to the requests naming them")
+
+    ("float-storage",
+            "keep the values of the text datasets in single precision, which "
+            "halves their memory")
+
+    ("compressed-storage",
+            "keep the values of the text datasets XOR compressed in blocks, "
+            "windows are decoded on access (overrides --float-storage)")
+
+    ("speculate",
+            "precompute the next window of every session that moves by "
+            "a constant step (needs --cache-size)")
+
+    ("batch-size", po::value<unsigned>()->default_value(1),
+            "set maximal number of requests computed by one batched model "
+            "call (1 - off)")
+
+    ("batch-window", po::value<unsigned>()->default_value(2000),
+            "set maximal time in microseconds a request waits for its batch "
+            "to fill up")
+
     ("debug-level,d",
             po::value<unsigned>()->default_value(debug::Informational),
             "set debug level (0-4)");
@@ -96,6 +170,87 @@ ParsedOptions parseOptions(int argc, char *argv[])
         opts.ListenPort = vm["listen-port"].as<unsigned> ();
     }
 
+    if (vm.count("workers"))
+    {
+        opts.Workers = vm["workers"].as<unsigned> ();
+    }
+
+    if (vm.count("table-file"))
+    {
+        opts.TableFiles = vm["table-file"].as<std::vector<std::string> > ();
+    }
+
+    if (vm.count("combiner-net"))
+    {
+        opts.CombinerNet = vm["combiner-net"].as<std::string> ();
+    }
+
+    opts.EnsembleArima = vm.count("ensemble-arima") > 0;
+
+    if (vm.count("io-cpus"))
+    {
+        opts.IoCpus = CpuTopology::parseCpuList(
+                vm["io-cpus"].as<std::string> ());
+    }
+
+    if (vm.count("worker-cpus"))
+    {
+        opts.WorkerCpus = CpuTopology::parseCpuList(
+                vm["worker-cpus"].as<std::string> ());
+    }
+
+    opts.NumaReplicate = vm.count("numa-replicate") > 0;
+    opts.Speculate = vm.count("speculate") > 0;
+    opts.Follow = vm.count("follow") > 0;
+
+    if (vm.count("stream-capacity"))
+    {
+        opts.StreamCapacity = vm["stream-capacity"].as<unsigned> ();
+    }
+
+    opts.FloatStorage = vm.count("float-storage") > 0;
+    opts.CompressedStorage = vm.count("compressed-storage") > 0;
+
+    if (vm.count("series-store"))
+    {
+        opts.SeriesStoreFile = vm["series-store"].as<std::string> ();
+    }
+
+    if (vm.count("resolutions"))
+    {
+        opts.Resolutions = vm["resolutions"].as<std::vector<unsigned> > ();
+    }
+
+    if (vm.count("data-dir"))
+    {
+        opts.DataDir = vm["data-dir"].as<std::string> ();
+    }
+
+    if (vm.count("memory-budget"))
+    {
+        opts.MemoryBudget = vm["memory-budget"].as<unsigned> ();
+    }
+
+    if (vm.count("snapshot-file"))
+    {
+        opts.SnapshotFile = vm["snapshot-file"].as<std::string> ();
+    }
+
+    if (vm.count("cache-size"))
+    {
+        opts.CacheSize = vm["cache-size"].as<unsigned> ();
+    }
+
+    if (vm.count("batch-size"))
+    {
+        opts.BatchSize = vm["batch-size"].as<unsigned> ();
+    }
+
+    if (vm.count("batch-window"))
+    {
+        opts.BatchWindow = vm["batch-window"].as<unsigned> ();
+    }
+
     if (vm.count("debug-level"))
     {
         unsigned val = vm["debug-level"].as<unsigned> ();
@@ -138,6 +293,14 @@ ParsedOptions parseOptions(int argc, char *argv[])
         if (it != allowedAlgorithms.end())
         {
             opts.Algorithm = algName;
+
+            if (algName == PredictionServer::ENSEMBLE
+                    && opts.CombinerNet.empty())
+            {
+                dbg(debug::Highest) << "Combiner net not provided. Exiting."
+                        << endl;
+                exit(1);
+            }
         }
         else
         {
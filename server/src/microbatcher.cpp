@@ -0,0 +1,150 @@
+//
+// Copyright (c) 2010 Dariusz Gadomski <dgadomski@gmail.com>
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <microbatcher.h>
+
+#include <util.h>
+
+#include <algorithm>
+
+#include <boost/bind.hpp>
+
+namespace prediction
+{
+
+namespace server
+{
+
+using namespace debug;
+
+namespace
+{
+// weight of the newest sample in the moving average of arrival gaps
+const double GAP_SMOOTHING = 0.2;
+}
+
+MicroBatcher::MicroBatcher(boost::asio::io_service& io_service,
+        size_t maxBatch, const boost::posix_time::time_duration& maxWindow,
+        const BatchHandler& onTimeout) :
+    _ioService(io_service), _timer(io_service), _maxBatch(std::max<size_t>(1, maxBatch)),
+            _maxWindow(maxWindow), _onTimeout(onTimeout), _generation(0),
+            _meanGap(maxWindow.total_microseconds())
+{
+}
+
+bool MicroBatcher::add(const RequestKey& key, const TaskInfo& info,
+        Batch& batch)
+{
+    boost::posix_time::ptime now =
+            boost::posix_time::microsec_clock::universal_time();
+
+    boost::lock_guard<boost::mutex> lock(_mutex);
+
+    if (!_lastArrival.is_not_a_date_time())
+    {
+        double gap = (now - _lastArrival).total_microseconds();
+        _meanGap += GAP_SMOOTHING * (gap - _meanGap);
+    }
+    _lastArrival = now;
+
+    Entry entry;
+    entry.Key = key;
+    entry.Info = info;
+    _pending.push_back(entry);
+
+    if (_pending.size() == 1)
+    {
+        boost::posix_time::time_duration window = currentWindow();
+        if (window > boost::posix_time::time_duration(0, 0, 0, 0))
+        {
+            // the timer is only touched by the I/O thread
+            _ioService.post(boost::bind(&MicroBatcher::startTimer, this,
+                    window, _generation));
+            return false;
+        }
+    }
+    else if (_pending.size() < _maxBatch)
+    {
+        return false;
+    }
+
+    batch.swap(_pending);
+    _pending.clear();
+    ++_generation;
+    return true;
+}
+
+boost::posix_time::time_duration MicroBatcher::getWindow() const
+{
+    boost::lock_guard<boost::mutex> lock(_mutex);
+    return currentWindow();
+}
+
+boost::posix_time::time_duration MicroBatcher::currentWindow() const
+{
+    if (_maxBatch <= 1 || _meanGap >= _maxWindow.total_microseconds())
+    {
+        return boost::posix_time::time_duration(0, 0, 0, 0);
+    }
+
+    double fill = _meanGap * (_maxBatch - 1);
+    return std::min<boost::posix_time::time_duration>(_maxWindow,
+            boost::posix_time::microseconds(static_cast<long> (fill)));
+}
+
+void MicroBatcher::startTimer(
+        const boost::posix_time::time_duration& window, unsigned generation)
+{
+    _timer.expires_from_now(window);
+    _timer.async_wait(boost::bind(&MicroBatcher::handle_timeout, this,
+            boost::asio::placeholders::error, generation));
+}
+
+void MicroBatcher::handle_timeout(const boost::system::error_code& e,
+        unsigned generation)
+{
+    if (e == boost::asio::error::operation_aborted)
+    {
+        return;
+    }
+
+    Batch batch;
+    {
+        boost::lock_guard<boost::mutex> lock(_mutex);
+        if (generation != _generation || _pending.empty())
+        {
+            return;
+        }
+        batch.swap(_pending);
+        ++_generation;
+    }
+
+    dbg(debug::Informational) << "Batch window expired with " << batch.size()
+            << " requests" << std::endl;
+    _onTimeout(batch);
+}
+
+}
+}
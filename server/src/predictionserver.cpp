@@ -24,11 +24,11 @@
 //
 
 #include <predictionserver.h>
+#include <serversnapshot.h>
 
 #include <comm/protocol.h>
-#include <arima/arima.h>
-#include <chaos/chaos.h>
-#include <grey/grey.h>
+#include <dataprovider/compressedseries.h>
+#include <modelfactory.h>
 #include <neural/neuralnet.h>
 #include <util.h>
 
@@ -38,6 +38,13 @@
 #include <boost/shared_ptr.hpp>
 #include <boost/thread/mutex.hpp>
 
+#include <algorithm>
+#include <csignal>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
 // Must come before boost/serialization headers.
 #include <comm/connection.h>
 #include <comm/protocol.h>
@@ -52,58 +59,577 @@ using namespace models::dataprovider;
 using namespace comm;
 using namespace debug;
 
+const char* PredictionServer::ENSEMBLE = "ensemble";
+const char* PredictionServer::COMBINER = "combiner";
+
+namespace
+{
+
+DataProvider::Precision getPrecision(const ParsedOptions& opts)
+{
+    if (opts.CompressedStorage)
+    {
+        return DataProvider::Compressed;
+    }
+    return opts.FloatStorage ? DataProvider::SinglePrecision
+            : DataProvider::DoublePrecision;
+}
+
+}
+
 PredictionServer::PredictionServer(boost::asio::io_service & io_service,
         const ParsedOptions& opts) :
-    _acceptor(io_service, boost::asio::ip::tcp::endpoint(
-            boost::asio::ip::tcp::v4(), opts.ListenPort)), _algorithm(
-            opts.Algorithm), _dataProvider(new DataProvider(opts.InputFile)),
-            _opts(opts)
-//  _connection(io_service), _algorithm(opts.Algorithm), _stopFlag(false),
-//          _predictionStarted(false), _opts(opts)
-{
-    connection_ptr new_conn(new connection(_acceptor.get_io_service()));
-    _acceptor.async_accept(new_conn->socket(), boost::bind(
-            &PredictionServer::handle_accept, this,
-            boost::asio::placeholders::error, new_conn));
+    _ioService(io_service), _acceptor(io_service,
+            boost::asio::ip::tcp::endpoint(boost::asio::ip::tcp::v4(),
+                    opts.ListenPort)), _signals(io_service, SIGINT, SIGTERM),
+            _algorithm(opts.Algorithm), _opts(opts), _batcher(io_service,
+                    opts.BatchSize, boost::posix_time::microseconds(
+                            opts.BatchWindow), boost::bind(
+                            &PredictionServer::postBatch, this, _1)),
+            _datasets(opts.DataDir, static_cast<size_t> (opts.MemoryBudget)
+                    << 20, getPrecision(opts)), _resultCache(opts.CacheSize), _sessionCount(0)
+{
+    unsigned numWorkers = std::max(1u, _opts.Workers);
+
+    // the I/O thread is the one which constructs the server and runs
+    // the io_service
+    if (!_opts.IoCpus.empty())
+    {
+        CpuTopology::pinCurrentThread(_opts.IoCpus);
+    }
+
+    if (_algorithm == ENSEMBLE)
+    {
+        _componentAlgorithms.push_back("chaos");
+        _componentAlgorithms.push_back("grey");
+        _componentAlgorithms.push_back("neural");
+        if (_opts.EnsembleArima)
+        {
+            _componentAlgorithms.push_back("arima");
+        }
+    }
+
+    if (_opts.Speculate && _resultCache.getCapacity() == 0)
+    {
+        dbg(debug::High) << "Speculation has no effect without --cache-size"
+                << std::endl;
+    }
+
+    if (_opts.SnapshotFile.empty() || !restoreSnapshot())
+    {
+        loadState();
+    }
+
+    if (_opts.Follow)
+    {
+        startStream();
+    }
+
+    loadPredictionTables();
+    buildPyramid();
+    loadSeriesStore();
+
+    for (unsigned i = 0; i < numWorkers; ++i)
+    {
+        _workers.create_thread(boost::bind(&PredictionServer::runWorker, this,
+                i));
+    }
+
+    _signals.async_wait(boost::bind(&PredictionServer::handle_signal, this,
+            boost::asio::placeholders::error));
+
+    startAccept();
+}
+
+PredictionServer::~PredictionServer()
+{
+    _scheduler.stop();
+    _workers.join_all();
+    std::cout << "~PredictionClient()" << std::endl;
+}
+
+void PredictionServer::loadState()
+{
+    // the followed file is read by the stream
+    _dataProvider.reset(_opts.Follow ? new DataProvider(_opts.InputFile,
+            std::vector<double>()) : new DataProvider(_opts.InputFile,
+            getPrecision(_opts)));
+    if (_dataProvider->getPrecision() == DataProvider::Compressed)
+    {
+        dbg(debug::Normal) << "Compressed " << _opts.InputFile << " to "
+                << _dataProvider->getMemoryUsage() << " bytes (ratio "
+                << _dataProvider->getCompressionRatio() << ")" << std::endl;
+    }
+
+    if (_algorithm == "neural" || _algorithm == ENSEMBLE)
+    {
+        loadNetDefinition("neural", models::ModelFactory::NEURAL_NET_FILE);
+    }
+    if (_algorithm == ENSEMBLE)
+    {
+        loadNetDefinition(COMBINER, _opts.CombinerNet);
+    }
+}
+
+void PredictionServer::startStream()
+{
+    _stream.reset(new StreamingDataProvider(_opts.InputFile,
+            _opts.StreamCapacity));
+    if (!_stream->start())
+    {
+        throw std::runtime_error("Cannot follow " + _opts.InputFile);
+    }
+}
+
+void PredictionServer::loadNetDefinition(const std::string& algorithm,
+        const std::string& filename)
+{
+    std::ifstream in(filename.c_str());
+    std::ostringstream oss;
+    oss << in.rdbuf();
+    _netDefinitions[algorithm] = oss.str();
+}
+
+bool PredictionServer::restoreSnapshot()
+{
+    ServerSnapshot snapshot;
+    if (!snapshot.load(_opts.SnapshotFile))
+    {
+        return false;
+    }
+
+    if (snapshot.Algorithm != _algorithm || snapshot.InputFile
+            != _opts.InputFile)
+    {
+        dbg(debug::High) << "Snapshot " << _opts.SnapshotFile
+                << " was taken for a different configuration" << std::endl;
+        return false;
+    }
+
+    if (!snapshot.isInputCurrent())
+    {
+        dbg(debug::High) << "Snapshot " << _opts.SnapshotFile
+                << " was taken of a different " << snapshot.InputFile
+                << std::endl;
+        return false;
+    }
+
+    DataProvider::Precision precision = getPrecision(_opts);
+    if (snapshot.Mapped)
+    {
+        _dataProvider.reset(new DataProvider(snapshot.InputFile, precision));
+    }
+    else if (snapshot.CompressedCount > 0)
+    {
+        boost::shared_ptr<const CompressedSeries> compressed(
+                new CompressedSeries(snapshot.CompressedBits,
+                        snapshot.CompressedBlocks, snapshot.CompressedCount));
+        if (compressed->getCount() != snapshot.CompressedCount)
+        {
+            dbg(debug::High) << "Snapshot " << _opts.SnapshotFile
+                    << " has corrupt compressed values" << std::endl;
+            return false;
+        }
+        _dataProvider.reset(new DataProvider(snapshot.InputFile, compressed));
+        if (precision != DataProvider::Compressed)
+        {
+            // the server was restarted with another storage
+            _dataProvider.reset(new DataProvider(snapshot.InputFile,
+                    _dataProvider->getItems(), precision));
+        }
+    }
+    else
+    {
+        _dataProvider.reset(new DataProvider(snapshot.InputFile,
+                snapshot.Data, precision));
+    }
+    _netDefinitions = snapshot.NetDefinitions;
+
+    for (size_t i = 0; i < snapshot.Results.size(); ++i)
+    {
+        _resultCache.insert(snapshot.Results[i].first,
+                snapshot.Results[i].second);
+    }
+
+    dbg(debug::Normal) << "Restored snapshot " << _opts.SnapshotFile << " ("
+            << _dataProvider->getDataSize() << " items in "
+            << _dataProvider->getMemoryUsage() << " bytes, "
+            << _resultCache.getSize() << " cached results)" << std::endl;
+    return true;
+}
+
+void PredictionServer::saveSnapshot()
+{
+    ServerSnapshot snapshot;
+    snapshot.Algorithm = _algorithm;
+    snapshot.InputFile = _opts.InputFile;
+    snapshot.stampInput();
+    if (_dataProvider->isMapped())
+    {
+        // the file is mapped again, its values stay out of the memory
+        snapshot.Mapped = true;
+    }
+    else if (boost::shared_ptr<const CompressedSeries> compressed =
+            _dataProvider->getCompressedSeries())
+    {
+        // saved encoded, so that the snapshot stays as small as the values
+        snapshot.CompressedBits = compressed->getBits();
+        snapshot.CompressedBlocks = compressed->getBlocks();
+        snapshot.CompressedCount = compressed->getCount();
+    }
+    else
+    {
+        snapshot.Data = _dataProvider->getItems();
+    }
+    snapshot.NetDefinitions = _netDefinitions;
+    snapshot.Results = _resultCache.getEntries();
+
+    if (snapshot.save(_opts.SnapshotFile))
+    {
+        dbg(debug::Normal) << "Saved snapshot " << _opts.SnapshotFile
+                << std::endl;
+    }
+    else
+    {
+        dbg(debug::High) << "Cannot save snapshot " << _opts.SnapshotFile
+                << std::endl;
+    }
+}
+
+void PredictionServer::handle_signal(const boost::system::error_code& e)
+{
+    if (!e)
+    {
+        dbg(debug::Normal) << "Shutting down" << std::endl;
+
+        if (!_opts.SnapshotFile.empty())
+        {
+            saveSnapshot();
+        }
+
+        _acceptor.close();
+        _ioService.stop();
+    }
+}
+
+void PredictionServer::runWorker(unsigned idx)
+{
+    WorkerContext *context = new WorkerContext;
+    _workerContexts.reset(context);
+
+    if (!_opts.WorkerCpus.empty())
+    {
+        unsigned cpu = _opts.WorkerCpus[idx % _opts.WorkerCpus.size()];
+        CpuTopology::pinCurrentThread(std::vector<unsigned>(1, cpu));
+        context->Node = _topology.getNode(cpu);
+
+        dbg(debug::Informational) << "Worker " << idx << " pinned to CPU "
+                << cpu << " (node " << context->Node << ")" << std::endl;
+    }
+
+    if (_opts.NumaReplicate)
+    {
+        context->LocalData = getNodeData(context->Node);
+    }
+
+    // models are created lazily by this thread, so their memory is
+    // allocated on the local node as well; the results are copied out of
+    // the arena before a task ends
+    _scheduler.run(boost::bind(&models::Arena::reset, &context->Arena));
+}
+
+PredictionServer::WorkerContext& PredictionServer::getWorkerContext()
+{
+    if (_workerContexts.get() == 0)
+    {
+        _workerContexts.reset(new WorkerContext);
+    }
+    return *_workerContexts;
+}
+
+boost::shared_ptr<DataProvider> PredictionServer::getNodeData(size_t node)
+{
+    boost::lock_guard<boost::mutex> lock(_nodeDataMutex);
+
+    if (_nodeData.size() <= node)
+    {
+        _nodeData.resize(node + 1);
+    }
+
+    // the first worker of the node copies the dataset, the pages of the
+    // copy (and of its own index) are then placed on the node by the
+    // first-touch policy
+    if (!_nodeData[node])
+    {
+        _nodeData[node].reset(new DataProvider(*_dataProvider));
+        _nodeData[node]->rebuildIndex();
+        dbg(debug::Informational) << "Dataset replicated on node " << node
+                << std::endl;
+    }
+
+    return _nodeData[node];
+}
+
+PredictionServer::dataset_ptr PredictionServer::getDataset(
+        const std::string& id)
+{
+    if (id.empty())
+    {
+        const WorkerContext *context = _workerContexts.get();
+        if (context && context->LocalData)
+        {
+            return context->LocalData;
+        }
+        return _dataProvider;
+    }
+    return _datasets.acquire(id);
+}
+
+PredictionServer::dataset_ptr PredictionServer::getDataset(
+        const RequestKey& key, size_t begin, size_t end)
+{
+    if (!key.SeriesId.empty())
+    {
+        return getStoredSeries(key);
+    }
+    if (key.Resolution > 1)
+    {
+        return getLevel(key);
+    }
+    if (key.DatasetId.empty() && _stream)
+    {
+        return end > begin ? _stream->getSnapshot(begin, end - begin)
+                : dataset_ptr();
+    }
+    return getDataset(key.DatasetId);
+}
+
+PredictionServer::dataset_ptr PredictionServer::getLevel(
+        const RequestKey& key) const
+{
+    // the pyramid is built for the default dataset only
+    if (!_pyramid || !key.DatasetId.empty())
+    {
+        return dataset_ptr();
+    }
+    return _pyramid->getLevel(key.Resolution, key.Aggregation);
+}
+
+PredictionServer::dataset_ptr PredictionServer::getStoredSeries(
+        const RequestKey& key) const
+{
+    // the stored series are served at their own resolution only
+    if (!_seriesStore || !key.DatasetId.empty() || key.Resolution > 1)
+    {
+        return dataset_ptr();
+    }
+    return _seriesStore->getSeries(key.SeriesId);
+}
+
+void PredictionServer::resolveLatest(RequestKey& key) const
+{
+    // named datasets may not be loaded yet, their size is not known in the
+    // I/O thread
+    size_t size = _stream ? _stream->getCount() : key.DatasetId.empty()
+            ? _dataProvider->getDataSize() : 0;
+    if (!key.SeriesId.empty())
+    {
+        dataset_ptr series = getStoredSeries(key);
+        size = series ? series->getDataSize() : 0;
+    }
+    else if (key.Resolution > 1)
+    {
+        dataset_ptr level = getLevel(key);
+        size = level ? level->getDataSize() : 0;
+    }
+    if (size >= key.DataLength)
+    {
+        key.DataOffset = size - key.DataLength;
+    }
+}
+
+const DataProvider& PredictionServer::getDataProvider() const
+{
+    const WorkerContext *context = _workerContexts.get();
+    if (context && context->LocalData)
+    {
+        return *context->LocalData;
+    }
+    return *_dataProvider;
+}
 
-    createPredictionModel(_algorithm);
+void PredictionServer::loadPredictionTables()
+{
+    if (_stream && !_opts.TableFiles.empty())
+    {
+        dbg(debug::High) << "Prediction tables are not used with --follow"
+                << std::endl;
+        return;
+    }
+
+    for (size_t i = 0; i < _opts.TableFiles.size(); ++i)
+    {
+        boost::shared_ptr<PredictionTable> table(new PredictionTable(
+                _opts.TableFiles[i]));
+
+        if (!table->isValid())
+        {
+            continue;
+        }
+
+        if (table->getAlgorithm() != _algorithm)
+        {
+            dbg(debug::High) << "Skipping " << _opts.TableFiles[i]
+                    << ": computed for " << table->getAlgorithm() << std::endl;
+            continue;
+        }
+
+        if (table->getHeader().DatasetSize != _dataProvider->getDataSize())
+        {
+            dbg(debug::High) << "Skipping " << _opts.TableFiles[i]
+                    << ": computed for a different dataset" << std::endl;
+            continue;
+        }
+
+        _predictionTables.push_back(table);
+    }
+}
+
+void PredictionServer::buildPyramid()
+{
+    if (_opts.Resolutions.empty())
+    {
+        return;
+    }
 
+    if (_stream)
+    {
+        dbg(debug::High) << "Resolutions are not used with --follow"
+                << std::endl;
+        return;
+    }
+
+    _pyramid.reset(new AggregationPyramid(*_dataProvider, _opts.Resolutions));
+    dbg(debug::Normal) << "Aggregation pyramid takes "
+            << _pyramid->getMemoryUsage() << " bytes" << std::endl;
+}
+
+void PredictionServer::loadSeriesStore()
+{
+    if (_opts.SeriesStoreFile.empty())
+    {
+        return;
+    }
+
+    _seriesStore.reset(new SeriesStore(_opts.SeriesStoreFile, getPrecision(
+            _opts)));
+    if (_seriesStore->getSeriesCount() == 0)
+    {
+        throw std::runtime_error("Cannot load " + _opts.SeriesStoreFile);
+    }
+
+    dbg(debug::Normal) << "Serving " << _seriesStore->getSeriesCount()
+            << " series of " << _seriesStore->getLength() << " values ("
+            << _seriesStore->getMemoryUsage() << " bytes)" << std::endl;
+}
+
+bool PredictionServer::lookupPredictionTables(const RequestKey& key,
+        double& prediction) const
+{
+    // the tables are computed for the default dataset only
+    if (!key.DatasetId.empty() || key.Resolution > 1 || !key.SeriesId.empty())
+    {
+        return false;
+    }
+
+    for (size_t i = 0; i < _predictionTables.size(); ++i)
+    {
+        if (_predictionTables[i]->lookup(key.DataOffset, key.DataLength,
+                key.Horizon, prediction))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void PredictionServer::startAccept()
+{
+    session_ptr session(new Session(_ioService,
+            _sessionCount++));
+    _acceptor.async_accept(session->connection()->socket(), boost::bind(
+            &PredictionServer::handle_accept, this,
+            boost::asio::placeholders::error, session));
 }
 
 void PredictionServer::handle_read(const boost::system::error_code& e,
-        connection_ptr conn)
+        session_ptr session)
 {
     if (!e)
     {
         dbg(debug::Informational) << "Handle read: " << std::endl;
-        dbg(debug::Informational) << _inBuffer << std::endl;
-
-        unsigned dataStart = _inBuffer.DataOffset;
-        unsigned dataLength = _inBuffer.DataLength;
-        unsigned horizon = _inBuffer.Horizon;
+        dbg(debug::Informational) << session->InBuffer << std::endl;
 
-        std::vector<double> inputBuffer(_dataProvider->getDataVector(dataStart,
-                dataLength));
+        comm::protocol::Message& msg = session->InBuffer;
+        RequestKey key(msg.DataOffset, msg.DataLength, msg.Horizon,
+                std::min<unsigned>(msg.Priority, protocol::NumPriorities - 1),
+                msg.DatasetId);
+        key.Resolution = std::max(1u, msg.Resolution);
+        key.Aggregation = msg.Aggregation;
+        key.SeriesId = msg.SeriesId;
 
-        _predictionModel->provideInput(inputBuffer, horizon);
+        // the window is fixed here, so it is cached and coalesced like any
+        // other one; the answer tells the client which one it was
+        if (msg.Latest && msg.DatasetId.empty())
+        {
+            resolveLatest(key);
+            msg.DataOffset = key.DataOffset;
+        }
 
-        double prediction = _predictionModel->getPrediction(horizon);
+        double prediction = 0.0;
+        CachedResult cached;
+        if (lookupPredictionTables(key, prediction))
+        {
+            sendResult(session, prediction, std::vector<double>());
+        }
+        else if (_resultCache.lookup(key, cached))
+        {
+            sendResult(session, cached.Prediction, cached.Components);
+        }
+        else if (_coalescer.join(key, session))
+        {
+            TaskInfo info;
+            info.Priority = key.Priority;
+            info.SessionId = session->getId();
+            if (msg.Deadline > 0)
+            {
+                info.Deadline = boost::posix_time::microsec_clock::universal_time()
+                        + boost::posix_time::milliseconds(msg.Deadline);
+            }
 
-//      if( _algorithm == std::string("neural") )
-//      {
-//          printSeq("!!! Input: ", inputBuffer, debug::High);
-//          dbg(debug::High) << "!!! Prediction: " << prediction << std::endl;
-//      }
+            _coalescer.setTask(key, _scheduler.post(boost::bind(
+                    &PredictionServer::computePrediction, this, key, info,
+                    session), info));
+        }
+        else
+        {
+            dbg(debug::Informational) << "Request coalesced (total: "
+                    << _coalescer.getCoalescedCount() << ")" << std::endl;
 
-        _outBuffer = _inBuffer;
-        _outBuffer.Result = prediction;
-        _outBuffer.Algorithm = _algorithm;
-        _outBuffer.DataOffset = _inBuffer.DataOffset;
-        _outBuffer.DataLength = _inBuffer.DataLength;
+            // e.g. the request joined its own speculative computation
+            WorkScheduler::TaskId task = 0;
+            if (_coalescer.raise(key, task) && _scheduler.raise(task,
+                    key.Priority))
+            {
+                dbg(debug::Informational) << "Raised queued computation to "
+                        << "class " << key.Priority << std::endl;
+            }
+        }
 
-        conn->async_write(_outBuffer, boost::bind(
-                &PredictionServer::handle_write, this,
-                boost::asio::placeholders::error, conn));
+        if (_opts.Speculate)
+        {
+            speculateNext(session, key);
+        }
     }
     else
     {
@@ -111,16 +637,343 @@ void PredictionServer::handle_read(const boost::system::error_code& e,
     }
 }
 
+void PredictionServer::speculateNext(session_ptr session,
+        const RequestKey& key)
+{
+    size_t lastOffset = session->LastOffset;
+    size_t lastLength = session->LastLength;
+    size_t lastHorizon = session->LastHorizon;
+    std::string lastDataset = session->LastDataset;
+    session->LastOffset = key.DataOffset;
+    session->LastLength = key.DataLength;
+    session->LastHorizon = key.Horizon;
+    session->LastDataset = key.getSeriesId();
+
+    // only a client moving forward with the same window is predictable
+    if (_resultCache.getCapacity() == 0 || lastLength != key.DataLength
+            || lastHorizon != key.Horizon || lastDataset != key.getSeriesId()
+            || key.DataOffset <= lastOffset)
+    {
+        return;
+    }
+
+    // the I/O thread does not load datasets
+    size_t dataSize = 0;
+    if (!key.SeriesId.empty())
+    {
+        dataset_ptr series = getStoredSeries(key);
+        dataSize = series ? series->getDataSize() : 0;
+    }
+    else if (key.Resolution > 1)
+    {
+        dataset_ptr level = getLevel(key);
+        dataSize = level ? level->getDataSize() : 0;
+    }
+    else if (key.DatasetId.empty())
+    {
+        dataSize = _stream ? _stream->getCount()
+                : _dataProvider->getDataSize();
+    }
+    else if (dataset_ptr data = _datasets.find(key.DatasetId))
+    {
+        dataSize = data->getDataSize();
+    }
+
+    // the speculation is queued as bulk work; the next real request joins
+    // it and raises it to its own class if it is still queued
+    RequestKey next(key);
+    next.DataOffset = 2 * key.DataOffset - lastOffset;
+    next.Priority = protocol::Bulk;
+    if (next.DataOffset + next.DataLength > dataSize)
+    {
+        return;
+    }
+
+    // speculate only when there is a worker with nothing else to do
+    if (_scheduler.getPendingCount() >= std::max(1u, _opts.Workers))
+    {
+        return;
+    }
+
+    double prediction = 0.0;
+    CachedResult cached;
+    if (lookupPredictionTables(next, prediction) || _resultCache.lookup(next,
+            cached))
+    {
+        return;
+    }
+
+    if (_coalescer.join(next, session_ptr()))
+    {
+        dbg(debug::Informational) << "Speculating on offset "
+                << next.DataOffset << std::endl;
+
+        TaskInfo info;
+        info.Priority = protocol::Bulk;
+        info.SessionId = session->getId();
+        _coalescer.setTask(next, _scheduler.post(boost::bind(
+                &PredictionServer::computePrediction, this, next, info,
+                session_ptr()), info));
+    }
+}
+
+void PredictionServer::computePrediction(const RequestKey& key,
+        const TaskInfo& info, session_ptr session)
+{
+    dataset_ptr data = getDataset(key, key.DataOffset, key.DataOffset
+            + key.DataLength);
+    if (!data || key.DataOffset + key.DataLength > data->getDataSize())
+    {
+        dbg(debug::High) << "Request for (" << key.DataOffset << ", "
+                << key.DataLength << ") of dataset '" << key.DatasetId
+                << "' is out of range" << std::endl;
+        _ioService.post(boost::bind(&PredictionServer::handle_computed, this,
+                key, std::numeric_limits<double>::quiet_NaN(),
+                std::vector<double>()));
+        return;
+    }
+
+    // clients walk forward through the data, the values of their next
+    // windows are read from the disk while this one is computed
+    data->prefetch(key.DataOffset + key.DataLength, key.DataLength);
+
+    if (_algorithm == ENSEMBLE)
+    {
+        // run every component model as a separate task, the last one to
+        // finish applies the combiner
+        boost::shared_ptr<EnsembleJob> job(new EnsembleJob(key,
+                _componentAlgorithms.size()));
+        job->Data = data;
+        job->Input = data->getView(key.DataOffset, key.DataLength);
+
+        for (size_t i = 0; i < _componentAlgorithms.size(); ++i)
+        {
+            _scheduler.post(boost::bind(&PredictionServer::computeComponent,
+                    this, job, i), info);
+        }
+        return;
+    }
+
+    models::AbstractModel *model = getPredictionModel(_algorithm, *data);
+    if (_opts.BatchSize > 1 && model->supportsBatch())
+    {
+        MicroBatcher::Batch batch;
+        if (_batcher.add(key, info, batch))
+        {
+            computeBatch(batch);
+        }
+        return;
+    }
+
+    if (model->supportsSliding() && session)
+    {
+        model = getSlidingModel(key, session, *data);
+    }
+    else
+    {
+        model->provideInput(data->getView(key.DataOffset, key.DataLength),
+                key.Horizon);
+    }
+
+    double prediction = model->getPrediction(key.Horizon);
+
+//  if( _algorithm == std::string("neural") )
+//  {
+//      printSeq("!!! Input: ", inputBuffer, debug::High);
+//      dbg(debug::High) << "!!! Prediction: " << prediction << std::endl;
+//  }
+
+    _ioService.post(boost::bind(&PredictionServer::handle_computed, this, key,
+            prediction, std::vector<double>()));
+}
+
+models::AbstractModel* PredictionServer::getSlidingModel(
+        const RequestKey& key, session_ptr session, const DataProvider& data)
+{
+    if (!session->SlidingModel)
+    {
+        session->SlidingModel.reset(createModel(_algorithm, data));
+    }
+    models::AbstractModel *model = session->SlidingModel.get();
+
+    // the session may be served by a different worker each time
+    model->setArena(&getWorkerContext().Arena);
+
+    // a client walking through the data usually moves its window by a few
+    // samples, so only the samples that entered the window are passed on
+    size_t advance = key.DataOffset - session->WindowOffset;
+    if (session->WindowDataset == key.getSeriesId() && session->WindowLength
+            == key.DataLength && key.DataOffset > session->WindowOffset
+            && advance < key.DataLength)
+    {
+        dbg(debug::Informational) << "Sliding session window by " << advance
+                << std::endl;
+        model->slideInput(data.getView(session->WindowOffset
+                + key.DataLength, advance), key.Horizon);
+    }
+    else
+    {
+        model->provideInput(data.getView(key.DataOffset, key.DataLength),
+                key.Horizon);
+    }
+
+    session->WindowOffset = key.DataOffset;
+    session->WindowLength = key.DataLength;
+    session->WindowDataset = key.getSeriesId();
+
+    return model;
+}
+
+void PredictionServer::postBatch(const MicroBatcher::Batch& batch)
+{
+    _scheduler.post(boost::bind(&PredictionServer::computeBatch, this, batch),
+            batch.front().Info);
+}
+
+void PredictionServer::computeBatch(const MicroBatcher::Batch& batch)
+{
+    dbg(debug::Informational) << "Computing batch of " << batch.size()
+            << " requests" << std::endl;
+
+    // every dataset (and every level of the pyramid) has its own scale of
+    // the net input, so the requests are grouped by the series
+    std::map<std::string, std::vector<size_t> > groups;
+    for (size_t i = 0; i < batch.size(); ++i)
+    {
+        groups[batch[i].Key.getSeriesId()].push_back(i);
+    }
+
+    for (std::map<std::string, std::vector<size_t> >::const_iterator it =
+            groups.begin(); it != groups.end(); ++it)
+    {
+        const std::vector<size_t>& members = it->second;
+        std::vector<double> predictions(members.size(),
+                std::numeric_limits<double>::quiet_NaN());
+
+        size_t begin = batch[members.front()].Key.DataOffset;
+        size_t end = begin;
+        for (size_t i = 0; i < members.size(); ++i)
+        {
+            const RequestKey& key = batch[members[i]].Key;
+            begin = std::min(begin, key.DataOffset);
+            end = std::max(end, key.DataOffset + key.DataLength);
+        }
+
+        dataset_ptr data = getDataset(batch[members.front()].Key, begin, end);
+        if (data)
+        {
+            data->prefetch(end, end - begin);
+
+            std::vector<models::DataView> inputs(members.size());
+            std::vector<unsigned> horizons(members.size());
+            for (size_t i = 0; i < members.size(); ++i)
+            {
+                const RequestKey& key = batch[members[i]].Key;
+                inputs[i] = data->getView(key.DataOffset, key.DataLength);
+                horizons[i] = key.Horizon;
+            }
+
+            getPredictionModel(_algorithm, *data)->predictBatch(inputs,
+                    horizons, predictions);
+        }
+
+        for (size_t i = 0; i < members.size(); ++i)
+        {
+            _ioService.post(boost::bind(&PredictionServer::handle_computed,
+                    this, batch[members[i]].Key, predictions[i],
+                    std::vector<double>()));
+        }
+    }
+}
+
+void PredictionServer::computeComponent(boost::shared_ptr<EnsembleJob> job,
+        size_t idx)
+{
+    const RequestKey& key = job->Key;
+
+    models::AbstractModel *model = getPredictionModel(
+            _componentAlgorithms[idx], *job->Data);
+    model->provideInput(job->Input, key.Horizon);
+    double prediction = model->getPrediction(key.Horizon);
+
+    {
+        boost::lock_guard<boost::mutex> lock(job->Mutex);
+        job->Components[idx] = prediction;
+        if (--job->Pending > 0)
+        {
+            return;
+        }
+    }
+
+    models::AbstractModel *combiner = getPredictionModel(COMBINER,
+            *job->Data);
+    combiner->provideInput(job->Components, key.Horizon);
+    double combined = combiner->getPrediction(key.Horizon);
+
+    _ioService.post(boost::bind(&PredictionServer::handle_computed, this, key,
+            combined, job->Components));
+}
+
+void PredictionServer::handle_computed(const RequestKey& key,
+        double prediction, const std::vector<double>& components)
+{
+    // failed requests (NaN) are not cached
+    if (prediction == prediction)
+    {
+        CachedResult result;
+        result.Prediction = prediction;
+        result.Components = components;
+        _resultCache.insert(key, result);
+    }
+
+    std::vector<session_ptr> waiters(_coalescer.complete(key));
+
+    for (size_t i = 0; i < waiters.size(); ++i)
+    {
+        // speculative computations have no session
+        if (waiters[i])
+        {
+            sendResult(waiters[i], prediction, components);
+        }
+    }
+}
+
+void PredictionServer::sendResult(session_ptr session, double prediction,
+        const std::vector<double>& components)
+{
+    session->OutBuffer = session->InBuffer;
+    session->OutBuffer.Result = prediction;
+    session->OutBuffer.Error.clear();
+    if (prediction != prediction)
+    {
+        // NaN cannot be sent in a text archive
+        session->OutBuffer.Result = 0.0;
+        session->OutBuffer.Error = "no data for the requested window";
+    }
+    session->OutBuffer.Algorithm = _algorithm;
+    session->OutBuffer.Components = components;
+    session->OutBuffer.ComponentAlgorithms.clear();
+    if (!components.empty())
+    {
+        session->OutBuffer.ComponentAlgorithms = _componentAlgorithms;
+    }
+
+    session->connection()->async_write(session->OutBuffer, boost::bind(
+            &PredictionServer::handle_write, this,
+            boost::asio::placeholders::error, session));
+}
+
 void PredictionServer::handle_write(const boost::system::error_code& e,
-        connection_ptr conn)
+        session_ptr session)
 {
     if (!e)
     {
         dbg(debug::Informational) << "Handle write: " << std::endl;
-        dbg(debug::Informational) << _outBuffer << std::endl;
+        dbg(debug::Informational) << session->OutBuffer << std::endl;
 
-        conn->async_read(_inBuffer, boost::bind(&PredictionServer::handle_read,
-                        this, boost::asio::placeholders::error, conn));
+        session->connection()->async_read(session->InBuffer, boost::bind(
+                &PredictionServer::handle_read, this,
+                boost::asio::placeholders::error, session));
     }
     else
     {
@@ -129,19 +982,17 @@ void PredictionServer::handle_write(const boost::system::error_code& e,
 }
 
 void PredictionServer::handle_accept(const boost::system::error_code& e,
-        connection_ptr conn)
+        session_ptr session)
 {
     if (!e)
     {
         dbg() << "Accepted connection!" << std::endl;
 
-        conn->async_read(_inBuffer, boost::bind(&PredictionServer::handle_read,
-                this, boost::asio::placeholders::error, conn));
+        session->connection()->async_read(session->InBuffer, boost::bind(
+                &PredictionServer::handle_read, this,
+                boost::asio::placeholders::error, session));
 
-        connection_ptr new_conn(new connection(_acceptor.get_io_service()));
-        _acceptor.async_accept(new_conn->socket(), boost::bind(
-                &PredictionServer::handle_accept, this,
-                boost::asio::placeholders::error, new_conn));
+        startAccept();
     }
     else
     {
@@ -152,53 +1003,56 @@ void PredictionServer::handle_accept(const boost::system::error_code& e,
     }
 }
 
-void PredictionServer::createPredictionModel(const std::string& algorithm)
+models::AbstractModel* PredictionServer::getPredictionModel(
+        const std::string& algorithm, const DataProvider& data)
 {
-    models::AbstractModel *model = 0;
+    WorkerContext& context = getWorkerContext();
 
-    if (algorithm == "arima")
-    {
-        models::arima::Arima *arima = new models::arima::Arima();
-        std::vector<int> order;
-        order.push_back(1);
-        order.push_back(2);
-        order.push_back(1);
-        arima->setOrder(order);
-        model = arima;
-    }
-    else if (algorithm == "grey")
-    {
-        model = new models::grey::Grey();
-    }
-    else if (algorithm == "chaos")
+    boost::shared_ptr<models::AbstractModel>& model =
+            context.Models[algorithm];
+    if (!model)
     {
-        model = new models::chaos::Chaos(3, 1);
+        model.reset(createModel(algorithm, data));
+        model->setArena(&context.Arena);
     }
-    else if (algorithm == "neural")
+    else if (_netDefinitions.count(algorithm))
     {
-        models::neural::NeuralNet *net = models::neural::NeuralNet::load("learning.net");
-        net->setScale(1.0 / _dataProvider->getMaxValue());
-        model = net;
+        // the net is shared by all datasets, its input is scaled by the
+        // maximum of the dataset being predicted
+        static_cast<models::neural::NeuralNet*> (model.get())->setScale(1.0
+                / data.getMaxValue());
     }
+    return model.get();
+}
 
-    if (model)
+models::AbstractModel* PredictionServer::createModel(
+        const std::string& algorithm, const DataProvider& data)
+{
+    std::map<std::string, std::string>::const_iterator def =
+            _netDefinitions.find(algorithm);
+    if (def != _netDefinitions.end())
     {
-        _predictionModel = boost::shared_ptr<models::AbstractModel>(model);
+        std::istringstream iss(def->second);
+        models::neural::NeuralNet *net = models::neural::NeuralNet::load(iss);
+        net->setScale(1.0 / data.getMaxValue());
+        return net;
     }
+
+    return models::ModelFactory::createModel(algorithm, data);
 }
 
 double PredictionServer::getPrediction(size_t offset, size_t length,
         size_t horizon, size_t progress)
 {
-    std::vector<double> inputVec = _dataProvider->getDataVector(offset, length);
-
+    const DataProvider& data = getDataProvider();
+    models::AbstractModel *model = getPredictionModel(_algorithm, data);
     if (progress == 0)
     {
-        _predictionModel->provideInput(inputVec, horizon);
+        model->provideInput(data.getView(offset, length), horizon);
     }
 
     // get prediction - progress=0 -> prediction for t+1 etc.
-    return _predictionModel->getPrediction(progress + 1);
+    return model->getPrediction(progress + 1);
 }
 
 }
@@ -0,0 +1,158 @@
+//
+// Copyright (c) 2010 Dariusz Gadomski <dgadomski@gmail.com>
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <requestcoalescer.h>
+
+#include <sstream>
+
+namespace prediction
+{
+
+namespace server
+{
+
+bool RequestKey::operator<(const RequestKey& other) const
+{
+    if (DataOffset != other.DataOffset)
+    {
+        return DataOffset < other.DataOffset;
+    }
+    if (DataLength != other.DataLength)
+    {
+        return DataLength < other.DataLength;
+    }
+    if (Horizon != other.Horizon)
+    {
+        return Horizon < other.Horizon;
+    }
+    if (DatasetId != other.DatasetId)
+    {
+        return DatasetId < other.DatasetId;
+    }
+    if (Resolution != other.Resolution)
+    {
+        return Resolution < other.Resolution;
+    }
+    if (Aggregation != other.Aggregation)
+    {
+        return Aggregation < other.Aggregation;
+    }
+    return SeriesId < other.SeriesId;
+}
+
+std::string RequestKey::getSeriesId() const
+{
+    if (!SeriesId.empty())
+    {
+        return "/#" + SeriesId;
+    }
+
+    if (Resolution <= 1)
+    {
+        return DatasetId;
+    }
+
+    // a dataset id never contains a slash, so this is not the id of
+    // another dataset
+    std::ostringstream oss;
+    oss << DatasetId << "/@" << Resolution << ":" << Aggregation;
+    return oss.str();
+}
+
+RequestCoalescer::RequestCoalescer() :
+    _coalescedCount(0)
+{
+}
+
+bool RequestCoalescer::join(const RequestKey& key, session_ptr session)
+{
+    boost::lock_guard<boost::mutex> lock(_mutex);
+
+    FlightMap::iterator it = _flights.find(key);
+    if (it != _flights.end())
+    {
+        it->second.Waiters.push_back(session);
+        ++_coalescedCount;
+        return false;
+    }
+
+    Flight& flight = _flights[key];
+    flight.Waiters.push_back(session);
+    flight.Priority = key.Priority;
+    return true;
+}
+
+void RequestCoalescer::setTask(const RequestKey& key,
+        WorkScheduler::TaskId task)
+{
+    boost::lock_guard<boost::mutex> lock(_mutex);
+
+    FlightMap::iterator it = _flights.find(key);
+    if (it != _flights.end())
+    {
+        it->second.HasTask = true;
+        it->second.Task = task;
+    }
+}
+
+bool RequestCoalescer::raise(const RequestKey& key,
+        WorkScheduler::TaskId& task)
+{
+    boost::lock_guard<boost::mutex> lock(_mutex);
+
+    FlightMap::iterator it = _flights.find(key);
+    if (it == _flights.end() || key.Priority >= it->second.Priority)
+    {
+        return false;
+    }
+
+    it->second.Priority = key.Priority;
+    task = it->second.Task;
+    return it->second.HasTask;
+}
+
+std::vector<session_ptr> RequestCoalescer::complete(const RequestKey& key)
+{
+    boost::lock_guard<boost::mutex> lock(_mutex);
+
+    std::vector<session_ptr> waiters;
+    FlightMap::iterator it = _flights.find(key);
+    if (it != _flights.end())
+    {
+        waiters.swap(it->second.Waiters);
+        _flights.erase(it);
+    }
+
+    return waiters;
+}
+
+unsigned long RequestCoalescer::getCoalescedCount() const
+{
+    boost::lock_guard<boost::mutex> lock(_mutex);
+    return _coalescedCount;
+}
+
+}
+}
@@ -0,0 +1,108 @@
+//
+// Copyright (c) 2010 Dariusz Gadomski <dgadomski@gmail.com>
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <resultcache.h>
+
+namespace prediction
+{
+
+namespace server
+{
+
+ResultCache::ResultCache(size_t capacity) :
+    _capacity(capacity)
+{
+}
+
+RequestKey ResultCache::normalize(const RequestKey& key)
+{
+    RequestKey tmp(key);
+    tmp.Priority = comm::protocol::Normal;
+    return tmp;
+}
+
+bool ResultCache::lookup(const RequestKey& key, CachedResult& result)
+{
+    boost::lock_guard<boost::mutex> lock(_mutex);
+
+    EntryIndex::iterator it = _index.find(normalize(key));
+    if (it == _index.end())
+    {
+        return false;
+    }
+
+    _entries.splice(_entries.begin(), _entries, it->second);
+    result = it->second->second;
+    return true;
+}
+
+void ResultCache::insert(const RequestKey& key, const CachedResult& result)
+{
+    if (_capacity == 0)
+    {
+        return;
+    }
+
+    RequestKey tmpKey(normalize(key));
+
+    boost::lock_guard<boost::mutex> lock(_mutex);
+
+    EntryIndex::iterator it = _index.find(tmpKey);
+    if (it != _index.end())
+    {
+        it->second->second = result;
+        _entries.splice(_entries.begin(), _entries, it->second);
+        return;
+    }
+
+    _entries.push_front(Entry(tmpKey, result));
+    _index[tmpKey] = _entries.begin();
+
+    if (_index.size() > _capacity)
+    {
+        _index.erase(_entries.back().first);
+        _entries.pop_back();
+    }
+}
+
+std::vector<ResultCache::Entry> ResultCache::getEntries() const
+{
+    boost::lock_guard<boost::mutex> lock(_mutex);
+    return std::vector<Entry>(_entries.rbegin(), _entries.rend());
+}
+
+size_t ResultCache::getCapacity() const
+{
+    return _capacity;
+}
+
+size_t ResultCache::getSize() const
+{
+    boost::lock_guard<boost::mutex> lock(_mutex);
+    return _index.size();
+}
+
+}
+}
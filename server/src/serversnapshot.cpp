@@ -0,0 +1,134 @@
+//
+// Copyright (c) 2010 Dariusz Gadomski <dgadomski@gmail.com>
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <serversnapshot.h>
+
+#include <util.h>
+
+#include <cstdio>
+#include <fstream>
+
+#include <sys/stat.h>
+
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/archive/binary_oarchive.hpp>
+
+namespace prediction
+{
+
+namespace server
+{
+
+using namespace debug;
+
+namespace
+{
+
+bool getStamp(const std::string& filename, boost::uint64_t& size,
+        boost::int64_t& time)
+{
+    struct stat info;
+    if (stat(filename.c_str(), &info) != 0)
+    {
+        return false;
+    }
+    size = info.st_size;
+    time = info.st_mtime;
+    return true;
+}
+
+}
+
+ServerSnapshot::ServerSnapshot() :
+    Mapped(false), InputSize(0), InputTime(0), CompressedCount(0)
+{
+}
+
+void ServerSnapshot::stampInput()
+{
+    if (!getStamp(InputFile, InputSize, InputTime))
+    {
+        InputSize = 0;
+        InputTime = 0;
+    }
+}
+
+bool ServerSnapshot::isInputCurrent() const
+{
+    boost::uint64_t size = 0;
+    boost::int64_t time = 0;
+    return getStamp(InputFile, size, time) && size == InputSize && time
+            == InputTime && InputTime != 0;
+}
+
+bool ServerSnapshot::save(const std::string& filename) const
+{
+    // write to a temporary file first, so that a crash during saving does
+    // not destroy the previous snapshot
+    std::string tmpFilename = filename + ".tmp";
+    try
+    {
+        std::ofstream out(tmpFilename.c_str(), std::ios::out
+                | std::ios::binary | std::ios::trunc);
+        boost::archive::binary_oarchive archive(out);
+        archive << *this;
+        out.close();
+        if (!out)
+        {
+            return false;
+        }
+    } catch (std::exception& e)
+    {
+        dbg(debug::High) << "Cannot save snapshot: " << e.what() << std::endl;
+        return false;
+    }
+
+    return std::rename(tmpFilename.c_str(), filename.c_str()) == 0;
+}
+
+bool ServerSnapshot::load(const std::string& filename)
+{
+    std::ifstream in(filename.c_str(), std::ios::in | std::ios::binary);
+    if (!in)
+    {
+        return false;
+    }
+
+    try
+    {
+        boost::archive::binary_iarchive archive(in);
+        archive >> *this;
+    } catch (std::exception& e)
+    {
+        dbg(debug::High) << "Cannot load snapshot " << filename << ": "
+                << e.what() << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+}
+}
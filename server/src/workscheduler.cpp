@@ -0,0 +1,198 @@
+//
+// Copyright (c) 2010 Dariusz Gadomski <dgadomski@gmail.com>
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <workscheduler.h>
+
+#include <algorithm>
+
+namespace prediction
+{
+
+namespace server
+{
+
+using namespace comm::protocol;
+
+WorkScheduler::WorkScheduler() :
+    _classes(NumPriorities), _stopped(false), _pending(0), _nextId(0)
+{
+}
+
+WorkScheduler::TaskId WorkScheduler::post(const Task& task,
+        const TaskInfo& info)
+{
+    Entry entry;
+    entry.Function = task;
+    entry.Deadline = info.Deadline;
+
+    {
+        boost::lock_guard<boost::mutex> lock(_mutex);
+        entry.Id = _nextId++;
+        PriorityClass& pc = _classes[std::min<unsigned>(info.Priority,
+                NumPriorities - 1)];
+        pc.Sessions[info.SessionId].push_back(entry);
+        ++pc.Pending;
+        ++_pending;
+    }
+
+    _taskAvailable.notify_one();
+    return entry.Id;
+}
+
+bool WorkScheduler::raise(TaskId id, unsigned priority)
+{
+    typedef std::map<unsigned, std::deque<Entry> >::iterator SessionIterator;
+
+    boost::lock_guard<boost::mutex> lock(_mutex);
+
+    for (size_t i = priority + 1; i < _classes.size(); ++i)
+    {
+        PriorityClass& pc = _classes[i];
+        for (SessionIterator it = pc.Sessions.begin(); it
+                != pc.Sessions.end(); ++it)
+        {
+            std::deque<Entry>& queue = it->second;
+            for (std::deque<Entry>::iterator entry = queue.begin(); entry
+                    != queue.end(); ++entry)
+            {
+                if (entry->Id != id)
+                {
+                    continue;
+                }
+
+                // the task keeps its session, so it is still served in the
+                // order of the session's other tasks of the new class
+                _classes[priority].Sessions[it->first].push_back(*entry);
+                ++_classes[priority].Pending;
+                queue.erase(entry);
+                if (queue.empty())
+                {
+                    pc.Sessions.erase(it);
+                }
+                --pc.Pending;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void WorkScheduler::run(const Task& onTaskDone)
+{
+    Task task;
+    while (pop(task))
+    {
+        task();
+        task.clear();
+
+        if (onTaskDone)
+        {
+            onTaskDone();
+        }
+    }
+}
+
+void WorkScheduler::stop()
+{
+    {
+        boost::lock_guard<boost::mutex> lock(_mutex);
+        _stopped = true;
+    }
+    _taskAvailable.notify_all();
+}
+
+size_t WorkScheduler::getPendingCount() const
+{
+    boost::lock_guard<boost::mutex> lock(_mutex);
+    return _pending;
+}
+
+bool WorkScheduler::pop(Task& task)
+{
+    typedef std::map<unsigned, std::deque<Entry> >::iterator SessionIterator;
+
+    boost::unique_lock<boost::mutex> lock(_mutex);
+
+    while (!_stopped && _pending == 0)
+    {
+        _taskAvailable.wait(lock);
+    }
+
+    if (_stopped)
+    {
+        return false;
+    }
+
+    for (size_t i = 0; i < _classes.size(); ++i)
+    {
+        PriorityClass& pc = _classes[i];
+        if (pc.Pending == 0)
+        {
+            continue;
+        }
+
+        // earliest deadline among the heads of the session queues
+        SessionIterator selected = pc.Sessions.end();
+        for (SessionIterator it = pc.Sessions.begin(); it
+                != pc.Sessions.end(); ++it)
+        {
+            const boost::posix_time::ptime& deadline =
+                    it->second.front().Deadline;
+            if (!deadline.is_not_a_date_time() && (selected
+                    == pc.Sessions.end() || deadline
+                    < selected->second.front().Deadline))
+            {
+                selected = it;
+            }
+        }
+
+        // no deadlines - next session in round-robin order
+        if (selected == pc.Sessions.end())
+        {
+            selected = pc.Sessions.lower_bound(pc.NextSession);
+            if (selected == pc.Sessions.end())
+            {
+                selected = pc.Sessions.begin();
+            }
+        }
+
+        task = selected->second.front().Function;
+        selected->second.pop_front();
+        pc.NextSession = selected->first + 1;
+        if (selected->second.empty())
+        {
+            pc.Sessions.erase(selected);
+        }
+
+        --pc.Pending;
+        --_pending;
+        return true;
+    }
+
+    return false;
+}
+
+}
+}
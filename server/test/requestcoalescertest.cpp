@@ -0,0 +1,212 @@
+//
+// Copyright (c) 2010 Dariusz Gadomski <dgadomski@gmail.com>
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#define BOOST_TEST_MODULE RequestCoalescer
+#include <boost/test/included/unit_test.hpp>
+
+#include <requestcoalescer.h>
+#include <workscheduler.h>
+
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+
+using namespace prediction::server;
+namespace protocol = comm::protocol;
+
+namespace
+{
+
+/// Stands in for the model: counts its runs and, like
+/// PredictionServer::handle_computed, completes the key when done.
+struct FakeComputation
+{
+    FakeComputation(RequestCoalescer& coalescer) :
+        Coalescer(coalescer), Runs(0), Started(false), Released(false)
+    {
+    }
+
+    void run(const RequestKey& key, int id)
+    {
+        boost::unique_lock<boost::mutex> lock(Mutex);
+        ++Runs;
+        Order.push_back(id);
+        Started = true;
+        Changed.notify_all();
+        while (!Released)
+        {
+            Changed.wait(lock);
+        }
+        Waiters = Coalescer.complete(key);
+    }
+
+    void waitForStart()
+    {
+        boost::unique_lock<boost::mutex> lock(Mutex);
+        while (!Started)
+        {
+            Changed.wait(lock);
+        }
+    }
+
+    void release()
+    {
+        boost::lock_guard<boost::mutex> lock(Mutex);
+        Released = true;
+        Changed.notify_all();
+    }
+
+    RequestCoalescer& Coalescer;
+    boost::mutex Mutex;
+    boost::condition_variable Changed;
+    int Runs;
+    bool Started;
+    bool Released;
+    std::vector<int> Order;
+    std::vector<session_ptr> Waiters;
+};
+
+// a speculation of the next window of a session, as speculateNext makes it
+RequestKey makeSpeculation()
+{
+    return RequestKey(100, 50, 1, protocol::Bulk);
+}
+
+TaskInfo makeInfo(unsigned priority, unsigned sessionId)
+{
+    TaskInfo info;
+    info.Priority = priority;
+    info.SessionId = sessionId;
+    return info;
+}
+
+}
+
+BOOST_AUTO_TEST_CASE(keyIgnoresPriority)
+{
+    RequestKey bulk(100, 50, 1, protocol::Bulk);
+    RequestKey realtime(100, 50, 1, protocol::Realtime);
+    BOOST_CHECK(!(bulk < realtime) && !(realtime < bulk));
+}
+
+BOOST_AUTO_TEST_CASE(requestJoinsRunningSpeculation)
+{
+    boost::asio::io_service ioService;
+    session_ptr session(new Session(ioService, 1));
+
+    WorkScheduler scheduler;
+    RequestCoalescer coalescer;
+    FakeComputation computation(coalescer);
+
+    RequestKey speculation(makeSpeculation());
+    BOOST_REQUIRE(coalescer.join(speculation, session_ptr()));
+    coalescer.setTask(speculation, scheduler.post(boost::bind(
+            &FakeComputation::run, &computation, speculation, 0), makeInfo(
+            protocol::Bulk, 1)));
+
+    boost::thread worker(boost::bind(&WorkScheduler::run, &scheduler,
+            WorkScheduler::Task()));
+    computation.waitForStart();
+
+    // the real request for the same window arrives while the model runs
+    RequestKey request(speculation);
+    request.Priority = protocol::Normal;
+    BOOST_CHECK(!coalescer.join(request, session));
+
+    WorkScheduler::TaskId task = 0;
+    BOOST_CHECK(coalescer.raise(request, task));
+    BOOST_CHECK(!scheduler.raise(task, request.Priority));
+
+    computation.release();
+    for (;;)
+    {
+        boost::this_thread::sleep(boost::posix_time::milliseconds(1));
+        boost::lock_guard<boost::mutex> lock(computation.Mutex);
+        if (!computation.Waiters.empty())
+        {
+            break;
+        }
+    }
+    scheduler.stop();
+    worker.join();
+
+    BOOST_CHECK_EQUAL(computation.Runs, 1);
+    BOOST_REQUIRE_EQUAL(computation.Waiters.size(), 2u);
+    BOOST_CHECK(computation.Waiters[1] == session);
+    BOOST_CHECK_EQUAL(coalescer.getCoalescedCount(), 1u);
+}
+
+BOOST_AUTO_TEST_CASE(requestRaisesQueuedSpeculation)
+{
+    boost::asio::io_service ioService;
+    session_ptr session(new Session(ioService, 1));
+
+    WorkScheduler scheduler;
+    RequestCoalescer coalescer;
+    FakeComputation computation(coalescer);
+    computation.release();
+
+    // bulk work of another session is queued ahead of the speculation
+    RequestKey backfill(5000, 50, 1, protocol::Bulk);
+    BOOST_REQUIRE(coalescer.join(backfill, session_ptr()));
+    coalescer.setTask(backfill, scheduler.post(boost::bind(
+            &FakeComputation::run, &computation, backfill, 1), makeInfo(
+            protocol::Bulk, 2)));
+
+    RequestKey speculation(makeSpeculation());
+    BOOST_REQUIRE(coalescer.join(speculation, session_ptr()));
+    coalescer.setTask(speculation, scheduler.post(boost::bind(
+            &FakeComputation::run, &computation, speculation, 0), makeInfo(
+            protocol::Bulk, 1)));
+
+    RequestKey request(speculation);
+    request.Priority = protocol::Realtime;
+    BOOST_CHECK(!coalescer.join(request, session));
+
+    WorkScheduler::TaskId task = 0;
+    BOOST_REQUIRE(coalescer.raise(request, task));
+    BOOST_CHECK(scheduler.raise(task, request.Priority));
+    // a second joiner of the same class does not raise it again
+    BOOST_CHECK(!coalescer.raise(request, task));
+    BOOST_CHECK_EQUAL(scheduler.getPendingCount(), 2u);
+
+    boost::thread worker(boost::bind(&WorkScheduler::run, &scheduler,
+            WorkScheduler::Task()));
+    for (;;)
+    {
+        boost::this_thread::sleep(boost::posix_time::milliseconds(1));
+        boost::lock_guard<boost::mutex> lock(computation.Mutex);
+        if (computation.Runs == 2)
+        {
+            break;
+        }
+    }
+    scheduler.stop();
+    worker.join();
+
+    // the raised speculation ran first and only once
+    BOOST_REQUIRE_EQUAL(computation.Order.size(), 2u);
+    BOOST_CHECK_EQUAL(computation.Order[0], 0);
+    BOOST_CHECK_EQUAL(computation.Order[1], 1);
+}
@@ -0,0 +1,117 @@
+//
+// Copyright (c) 2010 Dariusz Gadomski <dgadomski@gmail.com>
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// Converts a text dataset (one value per line) into the binary series file
+// format, which the data provider memory maps instead of parsing.
+
+#include <dataprovider/dataprovider.h>
+#include <dataprovider/seriesfile.h>
+#include <util.h>
+
+#include <iostream>
+
+#include <boost/program_options.hpp>
+
+using namespace std;
+using namespace models;
+using namespace models::dataprovider;
+
+namespace po = boost::program_options;
+
+struct ConvertOptions
+{
+    std::string InputFile;
+    std::string OutputFile;
+    bool SinglePrecision;
+};
+
+ConvertOptions parseOptions(int argc, char *argv[]);
+
+int main(int argc, char *argv[])
+{
+    try
+    {
+        ConvertOptions opts(parseOptions(argc, argv));
+        DataProvider dataProvider(opts.InputFile);
+
+        std::vector<double> values(dataProvider.getItems());
+        if (!SeriesFile::write(opts.OutputFile, values, opts.SinglePrecision))
+        {
+            debug::dbg(debug::Highest) << "Cannot write " << opts.OutputFile
+                    << std::endl;
+            return 1;
+        }
+
+        debug::dbg(debug::Normal) << "Written " << values.size()
+                << " values to " << opts.OutputFile << std::endl;
+    } catch (exception& e)
+    {
+        debug::dbg(debug::Highest) << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+ConvertOptions parseOptions(int argc, char *argv[])
+{
+    po::options_description desc("Convert options");
+    desc.add_options()("help,h", "produce help message")
+
+    ("input-file,i", po::value<std::string>(),
+            "set path to the text input file")
+
+    ("output-file,o", po::value<std::string>(),
+            "set path to the binary series file")
+
+    ("float", "store the values in single precision")
+
+    ("debug-level,d",
+            po::value<unsigned>()->default_value(debug::Normal),
+            "set debug level (0-4)");
+
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
+
+    if (vm.count("help") || !vm.count("input-file")
+            || !vm.count("output-file"))
+    {
+        cout << desc << endl;
+        exit(1);
+    }
+
+    unsigned val = vm["debug-level"].as<unsigned> ();
+    if (val >= debug::Debug && val <= debug::Highest)
+    {
+        debug::setVerbosity(static_cast<debug::DebugLevel> (val));
+    }
+
+    ConvertOptions opts;
+    opts.InputFile = vm["input-file"].as<std::string> ();
+    opts.OutputFile = vm["output-file"].as<std::string> ();
+    opts.SinglePrecision = vm.count("float") > 0;
+
+    return opts;
+}
@@ -0,0 +1,230 @@
+//
+// Copyright (c) 2010 Dariusz Gadomski <dgadomski@gmail.com>
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//  * Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+// Offline job computing the predictions of a single model for every window
+// of the dataset and storing them in a prediction table which can be served
+// by the prediction server (see --table-file).
+
+#include <dataprovider/dataprovider.h>
+#include <dataprovider/predictiontable.h>
+#include <modelfactory.h>
+#include <util.h>
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+#include <boost/bind.hpp>
+#include <boost/program_options.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread.hpp>
+
+using namespace std;
+using namespace models;
+using namespace models::dataprovider;
+
+namespace po = boost::program_options;
+
+const char* ALLOWED_ALGORITHMS[] =
+{ "arima", "chaos", "grey", "neural" };
+
+struct MaterializeOptions
+{
+    std::string Algorithm;
+    std::string InputFile;
+    std::string OutputFile;
+    unsigned DataOffset;
+    unsigned DataLength;
+    unsigned PredictionStep;
+    unsigned Horizon;
+    unsigned Threads;
+};
+
+MaterializeOptions parseOptions(int argc, char *argv[]);
+
+// number of windows whose values are read ahead at once
+const size_t PREFETCH_WINDOWS = 64;
+
+void computeRange(const MaterializeOptions& opts,
+        const DataProvider& dataProvider, std::vector<double>& predictions,
+        size_t begin, size_t end)
+{
+    boost::scoped_ptr<AbstractModel> model(ModelFactory::createModel(
+            opts.Algorithm, dataProvider));
+
+    // the values of a mapped series file are read ahead of the windows,
+    // the next batch is requested when half of the previous one is used
+    size_t ahead = std::max<size_t>(opts.DataLength, PREFETCH_WINDOWS
+            * opts.PredictionStep);
+    size_t prefetched = 0;
+
+    for (size_t i = begin; i < end; ++i)
+    {
+        size_t offset = opts.DataOffset + i * opts.PredictionStep;
+        if (offset + opts.DataLength + ahead / 2 >= prefetched)
+        {
+            dataProvider.prefetch(offset + opts.DataLength, ahead);
+            prefetched = offset + opts.DataLength + ahead;
+        }
+
+        model->provideInput(dataProvider.getView(offset, opts.DataLength),
+                opts.Horizon);
+        predictions[i] = model->getPrediction(opts.Horizon);
+    }
+
+    debug::dbg(debug::Informational) << "Computed predictions " << begin
+            << " - " << end << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+    try
+    {
+        MaterializeOptions opts(parseOptions(argc, argv));
+        DataProvider dataProvider(opts.InputFile);
+
+        size_t dataSize = dataProvider.getDataSize();
+        if (opts.DataOffset + opts.DataLength > dataSize)
+        {
+            debug::dbg(debug::Highest) << "Not enough data in "
+                    << opts.InputFile << std::endl;
+            return 1;
+        }
+
+        size_t count = (dataSize - opts.DataLength - opts.DataOffset)
+                / opts.PredictionStep + 1;
+        std::vector<double> predictions(count);
+
+        unsigned numThreads = std::max(1u, opts.Threads);
+        size_t chunk = (count + numThreads - 1) / numThreads;
+
+        boost::thread_group threads;
+        for (size_t begin = 0; begin < count; begin += chunk)
+        {
+            threads.create_thread(boost::bind(computeRange, boost::cref(opts),
+                    boost::cref(dataProvider), boost::ref(predictions), begin,
+                    std::min(begin + chunk, count)));
+        }
+        threads.join_all();
+
+        PredictionTableHeader header;
+        std::strncpy(header.Algorithm, opts.Algorithm.c_str(),
+                sizeof(header.Algorithm) - 1);
+        header.DatasetSize = dataSize;
+        header.DataLength = opts.DataLength;
+        header.Horizon = opts.Horizon;
+        header.Step = opts.PredictionStep;
+        header.FirstOffset = opts.DataOffset;
+
+        if (!PredictionTable::write(opts.OutputFile, header, predictions))
+        {
+            debug::dbg(debug::Highest) << "Cannot write " << opts.OutputFile
+                    << std::endl;
+            return 1;
+        }
+
+        debug::dbg(debug::Normal) << "Written " << count << " predictions to "
+                << opts.OutputFile << std::endl;
+    } catch (exception& e)
+    {
+        debug::dbg(debug::Highest) << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+MaterializeOptions parseOptions(int argc, char *argv[])
+{
+    po::options_description desc("Materialize options");
+    desc.add_options()("help,h", "produce help message")
+
+    ("algorithm,a", po::value<std::string>(),
+            "set prediction algorithm: arima, chaos, grey, neural")
+
+    ("input-file,i", po::value<std::string>(), "set path to the input file")
+
+    ("output-file,o", po::value<std::string>(),
+            "set path to the prediction table file")
+
+    ("data-offset", po::value<unsigned>()->default_value(0),
+            "set offset of the first window")
+
+    ("data-length", po::value<unsigned>()->default_value(100),
+            "set length of historical data used for each prediction")
+
+    ("prediction-step", po::value<unsigned>()->default_value(1),
+            "set distance between offsets of consecutive windows")
+
+    ("horizon,H", po::value<unsigned>()->default_value(1),
+            "set the forecast horizon")
+
+    ("threads,t", po::value<unsigned>()->default_value(
+            boost::thread::hardware_concurrency()),
+            "set number of computing threads")
+
+    ("debug-level,d",
+            po::value<unsigned>()->default_value(debug::Normal),
+            "set debug level (0-4)");
+
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
+
+    if (vm.count("help") || !vm.count("algorithm") || !vm.count("input-file")
+            || !vm.count("output-file"))
+    {
+        cout << desc << endl;
+        exit(1);
+    }
+
+    unsigned val = vm["debug-level"].as<unsigned> ();
+    if (val >= debug::Debug && val <= debug::Highest)
+    {
+        debug::setVerbosity(static_cast<debug::DebugLevel> (val));
+    }
+
+    MaterializeOptions opts;
+    opts.Algorithm = vm["algorithm"].as<std::string> ();
+
+    size_t numAlgs = sizeof(ALLOWED_ALGORITHMS) / sizeof(ALLOWED_ALGORITHMS[0]);
+    if (std::find(ALLOWED_ALGORITHMS, ALLOWED_ALGORITHMS + numAlgs,
+            opts.Algorithm) == ALLOWED_ALGORITHMS + numAlgs)
+    {
+        debug::dbg(debug::Highest)
+                << "Incorrect prediction algorithm provided. Exiting." << endl;
+        exit(1);
+    }
+
+    opts.InputFile = vm["input-file"].as<std::string> ();
+    opts.OutputFile = vm["output-file"].as<std::string> ();
+    opts.DataOffset = vm["data-offset"].as<unsigned> ();
+    opts.DataLength = vm["data-length"].as<unsigned> ();
+    opts.PredictionStep = std::max(1u, vm["prediction-step"].as<unsigned> ());
+    opts.Horizon = vm["horizon"].as<unsigned> ();
+    opts.Threads = vm["threads"].as<unsigned> ();
+
+    return opts;
+}